@@ -5,6 +5,9 @@ set(FREEMMS_BASEDIR_CORE_HEADERS ${FREEMMS_BASEDIR_CORE}/include)
 set(FREEMMS_CORE_SOURCES
         ${FREEMMS_BASEDIR_CORE}/json.hpp
         ${FREEMMS_BASEDIR_CORE}/MMSV.h
+        ${FREEMMS_BASEDIR_CORE}/MMSName.h
+        ${FREEMMS_BASEDIR_CORE}/MMSName.cpp
+        ${FREEMMS_BASEDIR_CORE}/MMSSmallVector.h
         ${FREEMMS_BASEDIR_CORE}/Field.h
         ${FREEMMS_BASEDIR_CORE}/MMSParserCursor.h
         ${FREEMMS_BASEDIR_CORE}/MMSEngine.cpp
@@ -12,8 +15,21 @@ set(FREEMMS_CORE_SOURCES
         ${FREEMMS_BASEDIR_CORE}/MMSInfo.cpp
         ${FREEMMS_BASEDIR_CORE}/MMSPart.h
         ${FREEMMS_BASEDIR_CORE}/MMSPart.cpp
+        ${FREEMMS_BASEDIR_CORE}/MMSMetaDataBuiltin.h
+        ${FREEMMS_BASEDIR_CORE}/MMSMetaDataSnapshot.h
+        ${FREEMMS_BASEDIR_CORE}/MMSMetaDataLayout.h
+        ${FREEMMS_BASEDIR_CORE}/MMSMetaDataBuilder.h
+        ${FREEMMS_BASEDIR_CORE}/MMSMetaDataBuilder.cpp
+        ${FREEMMS_BASEDIR_CORE}/MMSPerfectHash.h
+        ${FREEMMS_BASEDIR_CORE}/MMSPerfectHash.cpp
         ${FREEMMS_BASEDIR_CORE}/MMSMetaDataManager.h
         ${FREEMMS_BASEDIR_CORE}/MMSMetaDataManager.cpp
+        ${FREEMMS_BASEDIR_CORE}/MMSMetaDataRegistry.h
+        ${FREEMMS_BASEDIR_CORE}/MMSMetaDataRegistry.cpp
+        ${FREEMMS_BASEDIR_CORE}/MMSCharsetConverter.h
+        ${FREEMMS_BASEDIR_CORE}/MMSCharsetConverter.cpp
         ${FREEMMS_BASEDIR_CORE}/MMSHexDataParser.h
         ${FREEMMS_BASEDIR_CORE}/MMSHexDataParser.cpp
+        ${FREEMMS_BASEDIR_CORE}/MMSStreamParser.h
+        ${FREEMMS_BASEDIR_CORE}/MMSStreamParser.cpp
         )
\ No newline at end of file
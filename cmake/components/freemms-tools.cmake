@@ -0,0 +1,11 @@
+set(FREEMMS_BASEDIR_TOOLS ${CMAKE_SOURCE_DIR}/src/tools)
+
+set(FREEMMS_TOOLS_METAGEN_SOURCES
+        ${FREEMMS_BASEDIR_TOOLS}/mmsmetagen.cpp
+        ${CMAKE_SOURCE_DIR}/src/core/MMSMetaDataBuilder.cpp
+        ${CMAKE_SOURCE_DIR}/src/core/MMSPerfectHash.cpp)
+
+file(GLOB FREEMMS_METADATA_JSON ${CMAKE_SOURCE_DIR}/src/core/metadata/*.json)
+
+set(FREEMMS_GENERATED_DIR ${CMAKE_BINARY_DIR}/generated)
+set(FREEMMS_GENERATED_METADATA_SOURCES ${FREEMMS_GENERATED_DIR}/MMSMetaDataTables.cpp)
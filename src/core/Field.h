@@ -3,14 +3,99 @@
 
 #include <string>
 #include "MMSV.h"
+#include "MMSName.h"
+#include "MMSCharsetConverter.h"
+#include "MMSSmallVector.h"
 
+/**
+ * Encoded-string-value 声明的字符集
+ * name 为空时值不需要转换(UTF-8, US-ASCII, Any-charset, 或元数据中没有的 MIBenum);
+ * mibEnum 为 IANA MIBenum, 以元数据中没有的名字声明时为 -1, 此时 name 为声明的名字
+ */
+struct MMSCharset {
+    long mibEnum;
+    std::string name;
 
+    MMSCharset() : mibEnum(-1) {}
+};
+
+enum MMSValueType {
+    // value 为文本, 有 charset 时为未转换的原始字节
+    MMS_VALUE_TEXT,
+    // number 为整数, 如 Message-Size
+    MMS_VALUE_INTEGER,
+    // number 为自 1970-01-01 00:00:00 GMT 起的秒数
+    MMS_VALUE_TIMESTAMP,
+    // number 为相对的秒数
+    MMS_VALUE_DELTA,
+    // number 为 WSP 编码, symbol 为其在元数据中的名字
+    MMS_VALUE_ENUM
+};
+
+/**
+ * 头字段的类型化值, 数值和枚举类字段不再格式化为字符串, 需要时由 Field::text() 生成
+ */
+struct MMSTypedValue {
+    MMSValueType type;
+    long number;
+    MMSName symbol;
+
+    MMSTypedValue() : type(MMS_VALUE_TEXT), number(0) {}
+
+    MMSTypedValue(MMSValueType type, long number) : type(type), number(number) {}
+
+    MMSTypedValue(long code, MMSName symbol) : type(MMS_VALUE_ENUM), number(code), symbol(symbol) {}
+};
+
+/**
+ * WSP 中每个收件人地址都单独编码为一个 To/Cc 字段, 地址列表即为同名字段的序列
+ *
+ * 文本类字段(To, Cc, Subject, Message-ID 等)的 value 为传输的字节, 解析时不做字符集转换;
+ * charset.name 非空时这些字节按该字符集编码, 由 text() 转换为 UTF-8. 以下字段的 value 是解码后生成的文本:
+ * Content-Type 为媒体类型和参数, MMS-Version 为 "主版本.次版本", From 为 Insert-address-token 时为
+ * "[Placeholder]", Expiry 为未知 token 时为 Value-length 范围内字节的十六进制文本(如 0x82AABB).
+ * 数值和枚举类字段的 value 为空, 值在 typed 中
+ */
 template<typename T>
 struct Field {
-    MMSV<std::string> name;
+    MMSV<MMSName> name;
     T value;
+    MMSCharset charset;
+    MMSTypedValue typed;
+
+    /**
+     * @return 值的 UTF-8 字符串形式, 数值在调用时才格式化, Encoded-string-value 在调用时才做字符集转换.
+     * 结果不缓存, 每次调用都会重新生成, 需要多次使用时由调用方保存; 无法转换时返回原始字节
+     */
+    std::string text() const {
+        switch (typed.type) {
+            case MMS_VALUE_INTEGER:
+            case MMS_VALUE_TIMESTAMP:
+                return std::to_string(typed.number);
+            case MMS_VALUE_DELTA:
+                return "+" + std::to_string(typed.number);
+            case MMS_VALUE_ENUM:
+                return typed.symbol;
+            default:
+                break;
+        }
+
+        std::string out;
+        if (charset.name.empty()
+            || !MMSCharsetConverter::toUTF8(charset.name, value.value.data(), value.value.size(), out)) {
+            return value.value;
+        }
+        return out;
+    }
 };
 
 typedef Field<MMSV<std::string>> field;
 
+// PDU 头字段. 内联容量只覆盖投影时的少数字段, 完整解析的 10-20 个字段放在堆上,
+// 使 MMSInfo 移动时只转移指针而不是逐个移动内联的字段
+typedef MMSSmallVector<field, 4> MMSHeaderList;
+
+// part 头字段, 通常只有 Content-Type, Content-ID 和 Content-Location
+typedef MMSSmallVector<field, 4> MMSPartHeaderList;
+
 #endif //FREEMMS_FIELD_H
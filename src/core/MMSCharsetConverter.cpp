@@ -0,0 +1,301 @@
+#include "MMSCharsetConverter.h"
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+#include <iconv.h>
+#include <strings.h>
+
+using namespace std;
+
+static const iconv_t INVALID_ICONV = (iconv_t) -1;
+
+/**
+ * 线程退出时关闭该线程打开的所有转换器
+ */
+class IconvCache {
+private:
+    unordered_map<string, iconv_t> converters;
+
+public:
+    ~IconvCache() {
+        for (auto &converter: converters) {
+            if (converter.second != INVALID_ICONV) {
+                iconv_close(converter.second);
+            }
+        }
+    }
+
+    iconv_t get(const string &charset) {
+        auto it = converters.find(charset);
+        if (it != converters.end()) {
+            if (it->second != INVALID_ICONV) {
+                iconv(it->second, nullptr, nullptr, nullptr, nullptr);
+            }
+            return it->second;
+        }
+
+        iconv_t cd = iconv_open("UTF-8", charset.c_str());
+        converters.emplace(charset, cd);
+        return cd;
+    }
+};
+
+enum NativeCharset {
+    NATIVE_NONE,
+    NATIVE_UTF8,
+    NATIVE_ASCII,
+    NATIVE_LATIN1,
+    NATIVE_UCS2,
+    NATIVE_UTF16BE,
+    NATIVE_UTF16LE,
+    NATIVE_UTF16
+};
+
+static const struct {
+    const char *name;
+    NativeCharset charset;
+} nativeCharsets[] = {
+        {"UTF-8",           NATIVE_UTF8},
+        {"US-ASCII",        NATIVE_ASCII},
+        {"ASCII",           NATIVE_ASCII},
+        {"ISO_8859-1:1987", NATIVE_LATIN1},
+        {"ISO-8859-1",      NATIVE_LATIN1},
+        {"ISO_8859-1",      NATIVE_LATIN1},
+        {"ISO-10646-UCS-2", NATIVE_UCS2},
+        {"UCS-2",           NATIVE_UCS2},
+        {"UTF-16BE",        NATIVE_UTF16BE},
+        {"UTF-16LE",        NATIVE_UTF16LE},
+        {"UTF-16",          NATIVE_UTF16},
+};
+
+static NativeCharset findNativeCharset(const string &charset) {
+    for (auto &native: nativeCharsets) {
+        if (strcasecmp(charset.c_str(), native.name) == 0) {
+            return native.charset;
+        }
+    }
+    return NATIVE_NONE;
+}
+
+/**
+ * @return data 前 len 字节中第一个非 ASCII 字节的位置, 全部为 ASCII 时返回 len
+ * 每次按 8 字节检查最高位
+ */
+static size_t scanAscii(const char *data, size_t len) {
+    size_t i = 0;
+    for (; i + 8 <= len; i += 8) {
+        uint64_t word;
+        memcpy(&word, data + i, sizeof(word));
+        if (word & 0x8080808080808080ull) {
+            break;
+        }
+    }
+    while (i < len && (unsigned char) data[i] < 0x80) {
+        i++;
+    }
+    return i;
+}
+
+/**
+ * 把 cp 的 UTF-8 编码写到 w, 调用方保证至少有 4 字节空间
+ * @return 写入后的位置
+ */
+static char *writeUTF8(char *w, uint32_t cp) {
+    if (cp < 0x80) {
+        *w++ = (char) cp;
+    } else if (cp < 0x800) {
+        *w++ = (char) (0xC0 | (cp >> 6));
+        *w++ = (char) (0x80 | (cp & 0x3F));
+    } else if (cp < 0x10000) {
+        *w++ = (char) (0xE0 | (cp >> 12));
+        *w++ = (char) (0x80 | ((cp >> 6) & 0x3F));
+        *w++ = (char) (0x80 | (cp & 0x3F));
+    } else {
+        *w++ = (char) (0xF0 | (cp >> 18));
+        *w++ = (char) (0x80 | ((cp >> 12) & 0x3F));
+        *w++ = (char) (0x80 | ((cp >> 6) & 0x3F));
+        *w++ = (char) (0x80 | (cp & 0x3F));
+    }
+    return w;
+}
+
+/**
+ * 每个字节最多编码为 2 字节 UTF-8, 按最大长度预留后直接写入, 最后截断到实际长度
+ */
+static void decodeLatin1(const char *data, size_t len, string &out) {
+    out.resize(len * 2);
+    char *w = &out[0];
+    size_t i = 0;
+    while (i < len) {
+        size_t ascii = scanAscii(data + i, len - i);
+        memcpy(w, data + i, ascii);
+        w += ascii;
+        i += ascii;
+        for (; i < len && (unsigned char) data[i] >= 0x80; i++) {
+            w = writeUTF8(w, (unsigned char) data[i]);
+        }
+    }
+    out.resize((size_t) (w - out.data()));
+}
+
+/**
+ * @return 按内存顺序选中 8 字节中第 0, 2, 4, 6 字节的掩码, 与主机字节序无关
+ */
+static uint64_t evenOctetMask() {
+    static const unsigned char octets[8] = {0xFF, 0, 0xFF, 0, 0xFF, 0, 0xFF, 0};
+    uint64_t mask;
+    memcpy(&mask, octets, sizeof(mask));
+    return mask;
+}
+
+/**
+ * 从 p 开始的 4 个 UTF-16 码元都是 ASCII 时写入 w 并返回 true
+ * 一次读取 8 字节, 检查所有字节最高位为 0 且高位字节(大端在偶数位置, 小端在奇数位置)为 0
+ */
+static bool copyAsciiUnits(const unsigned char *p, bool bigEndian, char *w) {
+    static const uint64_t evenOctets = evenOctetMask();
+    uint64_t word;
+    memcpy(&word, p, sizeof(word));
+    uint64_t highOctets = bigEndian ? evenOctets : ~evenOctets;
+    if ((word & (0x8080808080808080ull | highOctets)) != 0) {
+        return false;
+    }
+    int lowOffset = bigEndian ? 1 : 0;
+    w[0] = (char) p[lowOffset];
+    w[1] = (char) p[2 + lowOffset];
+    w[2] = (char) p[4 + lowOffset];
+    w[3] = (char) p[6 + lowOffset];
+    return true;
+}
+
+/**
+ * 解码 UCS-2 / UTF-16, 不合法的代理项和末尾落单的字节替换为 U+FFFD
+ * 每个码元最多编码为 3 字节, 代理对 4 字节输入编码为 4 字节, 末尾落单字节编码为 3 字节,
+ * 按最大长度预留后直接写入; 连续的 ASCII 码元每次处理 4 个
+ */
+static void decodeUTF16(const char *data, size_t len, bool bigEndian, bool surrogates, string &out) {
+    auto p = reinterpret_cast<const unsigned char *>(data);
+    out.resize(len / 2 * 3 + 3);
+    char *w = &out[0];
+    size_t i = 0;
+    while (i + 1 < len) {
+        if (i + 8 <= len && copyAsciiUnits(p + i, bigEndian, w)) {
+            i += 8;
+            w += 4;
+            continue;
+        }
+        uint32_t unit = bigEndian ? (p[i] << 8 | p[i + 1]) : (p[i + 1] << 8 | p[i]);
+        i += 2;
+        if (unit < 0xD800 || unit > 0xDFFF) {
+            w = writeUTF8(w, unit);
+            continue;
+        }
+        if (surrogates && unit < 0xDC00 && i + 1 < len) {
+            uint32_t low = bigEndian ? (p[i] << 8 | p[i + 1]) : (p[i + 1] << 8 | p[i]);
+            if (low >= 0xDC00 && low <= 0xDFFF) {
+                i += 2;
+                w = writeUTF8(w, 0x10000 + ((unit - 0xD800) << 10) + (low - 0xDC00));
+                continue;
+            }
+        }
+        w = writeUTF8(w, 0xFFFD);
+    }
+    if (i < len) {
+        w = writeUTF8(w, 0xFFFD);
+    }
+    out.resize((size_t) (w - out.data()));
+}
+
+/**
+ * 常见字符集直接解码, 不经过 iconv
+ * @return 不是内置支持的字符集, 或数据不能按该字符集直接解码时返回 false
+ */
+static bool decodeNative(NativeCharset charset, const char *data, size_t len, string &out) {
+    auto p = reinterpret_cast<const unsigned char *>(data);
+    switch (charset) {
+        case NATIVE_UTF8:
+            out.assign(data, len);
+            return true;
+        case NATIVE_ASCII:
+            if (scanAscii(data, len) != len) {
+                return false;
+            }
+            out.assign(data, len);
+            return true;
+        case NATIVE_LATIN1:
+            decodeLatin1(data, len, out);
+            return true;
+        case NATIVE_UCS2:
+            decodeUTF16(data, len, true, false, out);
+            return true;
+        case NATIVE_UTF16BE:
+            decodeUTF16(data, len, true, true, out);
+            return true;
+        case NATIVE_UTF16LE:
+            decodeUTF16(data, len, false, true, out);
+            return true;
+        case NATIVE_UTF16:
+            // 按 BOM 判断字节序, 没有 BOM 时按大端处理
+            if (len >= 2 && p[0] == 0xFF && p[1] == 0xFE) {
+                decodeUTF16(data + 2, len - 2, false, true, out);
+            } else if (len >= 2 && p[0] == 0xFE && p[1] == 0xFF) {
+                decodeUTF16(data + 2, len - 2, true, true, out);
+            } else {
+                decodeUTF16(data, len, true, true, out);
+            }
+            return true;
+        default:
+            return false;
+    }
+}
+
+/**
+ * 调用 iconv 写入 scratch 的 written 位置之后, 输出空间不足(E2BIG)时扩容后继续
+ * in 为 nullptr 时输出复位序列
+ */
+static void iconvInto(iconv_t cd, char **in, size_t *inLen, vector<char> &scratch, size_t &written) {
+    for (;;) {
+        char *outChar = scratch.data() + written;
+        size_t outLen = scratch.size() - written;
+        size_t r = iconv(cd, in, inLen, &outChar, &outLen);
+        written = (size_t) (outChar - scratch.data());
+        if (r != (size_t) -1 || errno != E2BIG) {
+            // 遇到非法或不完整的输入时保留已转换的部分
+            return;
+        }
+        scratch.resize(scratch.size() * 2);
+    }
+}
+
+bool MMSCharsetConverter::toUTF8(const std::string &charset, const char *data, size_t len, std::string &out) {
+    static thread_local vector<char> scratch;
+    return toUTF8(charset, data, len, scratch, out);
+}
+
+bool MMSCharsetConverter::toUTF8(const std::string &charset, const char *data, size_t len,
+                                 std::vector<char> &scratch, std::string &out) {
+    if (decodeNative(findNativeCharset(charset), data, len, out)) {
+        return true;
+    }
+
+    static thread_local IconvCache cache;
+    iconv_t cd = cache.get(charset);
+    if (cd == INVALID_ICONV) {
+        return false;
+    }
+
+    // 大多数字符集转换到 UTF-8 后不超过原长度的 2 倍, 不够时由 iconvInto 扩容
+    if (scratch.size() < len * 2 + 16) {
+        scratch.resize(len * 2 + 16);
+    }
+    char *inChar = const_cast<char *>(data);
+    size_t inLen = len;
+    size_t written = 0;
+    iconvInto(cd, &inChar, &inLen, scratch, written);
+    iconvInto(cd, nullptr, nullptr, scratch, written);
+    // 多字节字符集 (如 UCS-2) 的输出中可能含 0 字节, 也不保证以 0 结尾, 按实际写入长度构造
+    out.assign(scratch.data(), written);
+    return true;
+}
@@ -0,0 +1,31 @@
+#ifndef FREEMMS_MMSCHARSETCONVERTER_H
+#define FREEMMS_MMSCHARSETCONVERTER_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * 字符集转换
+ * UTF-8, US-ASCII, ISO-8859-1, UCS-2 和 UTF-16 直接解码, 其余字符集(如 GB2312, Shift_JIS)使用 iconv,
+ * 每个线程按字符集缓存打开的 iconv 转换器
+ * glibc 的 iconv_open 需要加载 gconv 模块, 开销远大于转换几十个字节, 因此转换器打开后复用,
+ * 每次转换前只重置其移位状态; 打开失败的字符集同样缓存, 不会重复尝试
+ */
+class MMSCharsetConverter {
+public:
+    /**
+     * 将 charset 编码的 data 转换为 UTF-8, 使用当前线程复用的输出缓冲区
+     *
+     * @return 不支持该字符集时返回 false, out 不变
+     */
+    static bool toUTF8(const std::string &charset, const char *data, size_t len, std::string &out);
+
+    /**
+     * 同上, iconv 的输出先写入 scratch, scratch 按需扩容且不会缩小, 供调用方在多次转换间复用
+     */
+    static bool toUTF8(const std::string &charset, const char *data, size_t len,
+                       std::vector<char> &scratch, std::string &out);
+};
+
+#endif //FREEMMS_MMSCHARSETCONVERTER_H
@@ -3,6 +3,10 @@
 #include <utility>
 #include <boost/filesystem.hpp>
 #include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include "spdlog/spdlog.h"
 #include "MMSHexDataParser.h"
 #include "MMSInfo.h"
@@ -10,27 +14,79 @@
 using namespace std;
 using namespace boost;
 
-inline static MMSInfo *convertHexFile(MMSMetaDataManager &metaDataManager, const std::string &mmsHexFilePath) {
-    ifstream mmsHexFile(mmsHexFilePath);
-    if (!mmsHexFile.is_open()) {
+/**
+ * 以只读 mmap 的方式映射 MMS 文件, 解析器直接读取映射内存, 不再拷贝到堆上
+ * 映射失败(如空文件)时回退为普通读取
+ */
+inline static std::shared_ptr<const char> mapHexFile(const std::string &mmsHexFilePath, size_t &len) {
+    int fd = open(mmsHexFilePath.c_str(), O_RDONLY);
+    if (fd < 0) {
         spdlog::error("file not exist {}", mmsHexFilePath);
         return nullptr;
     }
 
-    mmsHexFile.seekg(0, ios::end);
-    streamsize len = mmsHexFile.tellg();
+    struct stat st = {};
+    if (fstat(fd, &st) != 0) {
+        spdlog::error("can not stat file {}", mmsHexFilePath);
+        close(fd);
+        return nullptr;
+    }
+    len = st.st_size;
+
+    void *addr = len > 0 ? mmap(nullptr, len, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+    if (addr != MAP_FAILED) {
+        close(fd);
+        madvise(addr, len, MADV_SEQUENTIAL);
+        madvise(addr, len, MADV_WILLNEED);
+        return std::shared_ptr<const char>(static_cast<const char *>(addr), [len](const char *p) {
+            munmap(const_cast<char *>(p), len);
+        });
+    }
+
     char *buffer = new char[len];
-    mmsHexFile.seekg(0, ios::beg);
-    mmsHexFile.read(buffer, len);
-    mmsHexFile.close();
+    ssize_t readLen = 0;
+    while (readLen < (ssize_t) len) {
+        ssize_t r = read(fd, buffer + readLen, len - readLen);
+        if (r <= 0) {
+            break;
+        }
+        readLen += r;
+    }
+    close(fd);
+    len = readLen;
+    return std::shared_ptr<const char>(buffer, std::default_delete<char[]>());
+}
 
+inline static MMSInfo *convertHexData(const std::shared_ptr<const MMSMetaDataManager> &metaDataManager,
+                                      const char *data, size_t len, const MMSParseOptions &options) {
     MMSHexData mmsHexData = MMSHexData();
     mmsHexData.length = len;
-    mmsHexData.data = buffer;
+    mmsHexData.data = const_cast<char *>(data);
+
+    MMSHexDataParser hexDataParser = MMSHexDataParser(*metaDataManager, mmsHexData, options);
+    try {
+        auto mmsInfo = new MMSInfo(hexDataParser.parse());
+        // 结果中的名字指向元数据的字符串池, 延迟解码时也需要解析开始时的元数据版本
+        mmsInfo->holdMetaData(metaDataManager);
+        return mmsInfo;
+    } catch (const MMSParseError &e) {
+        spdlog::error("parse mms error: {}", e.what());
+        return nullptr;
+    }
+}
+
+inline static MMSInfo *convertHexFile(const std::shared_ptr<const MMSMetaDataManager> &metaDataManager,
+                                      const std::string &mmsHexFilePath) {
+    size_t len = 0;
+    std::shared_ptr<const char> buffer = mapHexFile(mmsHexFilePath, len);
+    if (!buffer) {
+        return nullptr;
+    }
 
-    MMSHexDataParser hexDataParser = MMSHexDataParser(metaDataManager, mmsHexData);
-    auto mmsInfo = new MMSInfo(hexDataParser.parse());
-    delete[] buffer;
+    auto mmsInfo = convertHexData(metaDataManager, buffer.get(), len, MMSParseOptions());
+    if (mmsInfo != nullptr) {
+        mmsInfo->holdData(buffer);
+    }
     return mmsInfo;
 }
 
@@ -39,33 +95,28 @@ MMSEngine::MMSEngine() {
 }
 
 MMSEngine::MMSEngine(std::string configDir) {
-    this->initMMSMetaDataManager(std::move(configDir));
-}
-
-MMSEngine::~MMSEngine() {
-    delete metaDataManager;
+    this->initMMSMetaDataManager(configDir);
 }
 
+MMSEngine::~MMSEngine() = default;
 
-void MMSEngine::initMMSMetaDataManager(std::string configDir) {
-    if (configDir.length() == 0) {
-        configDir = "metadata";
-    }
 
-    if (!filesystem::exists(configDir)) {
-        spdlog::error("config dir {} not exist", configDir);
-        throw runtime_error("config dir " + configDir + " not exist");
-    }
-
-    this->metaDataManager = new MMSMetaDataManager(configDir);
+void MMSEngine::initMMSMetaDataManager(const std::string &configDir) {
+    this->metaDataSlot = MMSMetaDataRegistry::slot(configDir);
 }
 
 
 std::string MMSEngine::convert2Plain(const std::string &mmsHexFilePath, bool withBinaryBody) {
-    MMSInfo *mmsInfo = convertHexFile(*metaDataManager, mmsHexFilePath);
-    string data = mmsInfo->toPlain(withBinaryBody);
-    delete mmsInfo;
-    return data;
+    std::unique_ptr<MMSInfo> mmsInfo(convertHexFile(metaDataSlot->snapshot(), mmsHexFilePath));
+    if (!mmsInfo) {
+        return "";
+    }
+    try {
+        return mmsInfo->toPlain(withBinaryBody);
+    } catch (const MMSParseError &e) {
+        spdlog::error("parse mms error: {}", e.what());
+        return "";
+    }
 }
 
 std::string MMSEngine::convert2Plain(const string &mmsHexFilePath) {
@@ -89,7 +140,7 @@ void MMSEngine::convert2PlainFile(const string &mmsHexFilePath, const string &ou
     convert2PlainFile(mmsHexFilePath, outFile, false);
 }
 
-inline static std::string getPartFileName(const std::list<field> &headInfo) {
+inline static std::string getPartFileName(const MMSPartHeaderList &headInfo) {
     auto it = std::find_if(headInfo.begin(), headInfo.end(), [](const field &f) -> bool {
         return f.name.value == "Content-Location";
     });
@@ -101,8 +152,20 @@ inline static std::string getPartFileName(const std::list<field> &headInfo) {
 }
 
 void MMSEngine::convert2PlainDirectory(const string &mmsHexFilePath, const string &outDir) {
-    MMSInfo *mmsInfo = convertHexFile(*metaDataManager, mmsHexFilePath);
-    string data = mmsInfo->toPlain(false);
+    std::unique_ptr<MMSInfo> mmsInfo(convertHexFile(metaDataSlot->snapshot(), mmsHexFilePath));
+    if (!mmsInfo) {
+        return;
+    }
+
+    string data;
+    const std::vector<MMSPart> *body;
+    try {
+        data = mmsInfo->toPlain(false);
+        body = mmsInfo->body();
+    } catch (const MMSParseError &e) {
+        spdlog::error("parse mms error: {}", e.what());
+        return;
+    }
 
     if (!filesystem::exists(outDir)) {
         filesystem::remove(outDir);
@@ -119,19 +182,33 @@ void MMSEngine::convert2PlainDirectory(const string &mmsHexFilePath, const strin
     fMain.flush();
     fMain.close();
 
-    for (auto &part: *mmsInfo->body()) {
-        string fileName = getPartFileName(part->header());
+    for (auto &part: *body) {
+        string fileName = getPartFileName(part.header());
         if (!fileName.empty()) {
             string ft = outDir;
             ft.append("/").append(fileName);
             ofstream fP(ft);
-            fP.write(part->data(), part->dataLen());
+            fP.write(part.data(), part.dataLen());
             fP.flush();
             fP.close();
         }
     }
+}
+
+MMSInfo *MMSEngine::parse(const void *data, std::size_t length) {
+    return parse(data, length, MMSParseOptions());
+}
+
+MMSInfo *MMSEngine::parse(const void *data, std::size_t length, const MMSParseOptions &options) {
+    if (data == nullptr || length == 0) {
+        spdlog::error("mms data is empty");
+        return nullptr;
+    }
+    return convertHexData(metaDataSlot->snapshot(), static_cast<const char *>(data), length, options);
+}
 
-    delete mmsInfo;
+MMSStreamParser *MMSEngine::createStreamParser(MMSStreamListener &listener) {
+    return new MMSStreamParser(metaDataSlot->snapshot(), listener);
 }
 
 MMSHexData *MMSEngine::convert2mmsHex(const std::string &mmsPlain) {
@@ -1,9 +1,20 @@
 #include "MMSHexDataParser.h"
+#include <bitset>
+#include <list>
 #include <spdlog/spdlog.h>
-#include <iconv.h>
+#include <climits>
+#include <cstring>
 
 #define CONTENT_TYPE "Content-Type"
 
+// Any-charset 没有 MIBenum, 用 0 表示
+#define ANY_CHARSET 0
+#define MIB_US_ASCII 3
+#define MIB_UTF_8 106
+
+// 常见 PDU 头的字段数, 完整解析时按此预留
+#define TYPICAL_HEADER_FIELDS 20
+
 using namespace std;
 
 /**
@@ -29,6 +40,21 @@ static int readShortInteger(cursor c, size_t &len) {
     return markV & 0x7F;
 }
 
+/**
+ * 查找字符串结束符 End-of-string(Octet 0)
+ * 使用 libc 的 memchr, glibc 会按 CPU 分派到 SSE2/AVX2 的向量化实现, 否则退化为逐字节扫描
+ * 扫描范围不超过游标的结束位置, 找不到结束符时抛出 MMSParseError
+ *
+ * @return 结束符之前的字节数
+ */
+static inline size_t scanEndOfString(cursor c) {
+    auto eos = static_cast<const char *>(memchr(c.begin, '\0', c.remaining()));
+    if (eos == nullptr) {
+        throw MMSParseError("string is not terminated, start " + to_string(c.gOffset));
+    }
+    return eos - c.begin;
+}
+
 /**
  * 读令牌
  *  @Note: 不符合规范不会自动回退,如果需要回退可手动调用
@@ -48,16 +74,9 @@ static int readShortInteger(cursor c, size_t &len) {
  * @return 返回读取的字符串
  */
 static std::string readTokenText(cursor c, size_t &len) {
-    std::vector<unsigned char> dat;
-
-    char tmp;
-    do {
-        tmp = *c.begin++;
-        dat.push_back(tmp);
-    } while (tmp != '\0');
-
-    len = dat.size();
-    return {dat.begin(), dat.end() - 1};
+    size_t n = scanEndOfString(c);
+    len = n + 1;
+    return {c.begin, n};
 }
 
 /**
@@ -76,20 +95,13 @@ static std::string readTokenText(cursor c, size_t &len) {
  * @return 返回读取的字符串
  */
 static std::string readTextString(cursor c, size_t &len) {
-    std::vector<unsigned char> dat;
-
-    char tmp;
-    do {
-        tmp = *c.begin++;
-        dat.push_back(tmp);
-    } while (tmp != '\0');
-
-    len = dat.size();
+    size_t n = scanEndOfString(c);
+    len = n + 1;
 
-    if (dat[0] == 127 && dat[1] > 127) {
-        return {dat.begin() + 1, dat.end() - 1};
+    if (n > 1 && (unsigned char) c.begin[0] == 127 && (unsigned char) c.begin[1] > 127) {
+        return {c.begin + 1, n - 1};
     } else {
-        return {dat.begin(), dat.end() - 1};
+        return {c.begin, n};
     }
 }
 
@@ -119,9 +131,12 @@ static long readUIntVarInteger(cursor c, size_t &len) {
     auto temp = *c;
     long result = 0;
     while ((temp & 0x80) != 0) {
+        if (len == 5) {
+            throw MMSParseError("uintvar is longer than 5 octets, start " + to_string(c.gOffset));
+        }
         result = result << 7;
         result |= temp & 0x7F;
-        temp = *++c.begin;
+        temp = *c.offset((ptrdiff_t) len);
         len++;
     }
 
@@ -195,15 +210,23 @@ static long readValueLength(cursor c, size_t &len) {
 static long readLongInteger(cursor c, size_t &len) {
     size_t shortLength = 0;
     int sl = readShortLength(c, shortLength);
+    if ((size_t) sl > sizeof(long)) {
+        throw MMSParseError("long integer is longer than " + to_string(sizeof(long)) + " octets, start "
+                            + to_string(c.gOffset));
+    }
+    c.require(shortLength + sl);
 
     const auto *dataBegin = reinterpret_cast<const unsigned char *>(c.begin + shortLength);
-    long result = 0;
+    unsigned long result = 0;
     for (int i = 0; i < sl; i++) {
-        result |= dataBegin[i] << (8 * sl - 8 * i - 8);
+        result = (result << 8) | (unsigned long) dataBegin[i];
+    }
+    if (result > (unsigned long) LONG_MAX) {
+        throw MMSParseError("long integer is out of range, start " + to_string(c.gOffset));
     }
 
     len = shortLength + sl;
-    return result;
+    return (long) result;
 }
 
 /**
@@ -233,16 +256,27 @@ static long readIntegerValue(cursor c, size_t &len) {
  *  Well-known-charset = Any-charset | Integer-value
  *  Any-charset = <Octet 128>
  *
- * @return 整数类型
+ * @return MIBenum, Any-charset 返回 ANY_CHARSET
  */
-static std::string readWellKnowCharset(MMSMetaDataManager &metaDataManager, cursor c, size_t &len) {
-    auto markV = *c;
-    if (markV == 128) {
-        return "Auto";
+static long readWellKnowCharsetCode(cursor c, size_t &len) {
+    if (*c == 128) {
+        len = 1;
+        return ANY_CHARSET;
     }
+    return readIntegerValue(c, len);
+}
 
-    long v = readIntegerValue(c, len);
-    return metaDataManager.findCharacterSetByCode(v & 0x7F);
+/**
+ * 读取著名字符集编码
+ *
+ * @return 字符集名
+ */
+static std::string readWellKnowCharset(const MMSMetaDataManager &metaDataManager, cursor c, size_t &len) {
+    long mibEnum = readWellKnowCharsetCode(c, len);
+    if (mibEnum == ANY_CHARSET) {
+        return "Auto";
+    }
+    return metaDataManager.findCharacterSetByCode(mibEnum);
 }
 
 /**
@@ -250,14 +284,19 @@ static std::string readWellKnowCharset(MMSMetaDataManager &metaDataManager, curs
  *
  * charset = Well-known-charset|Text-String
  *
- * @return 整数或者字符串类型
+ * @return MIBenum, Text-String 按名字查找, 元数据中没有时返回 -1 并将名字写入 name
  */
-static std::string readCharset(MMSMetaDataManager &metaDataManager, cursor c, size_t &len) {
+static long readCharset(const MMSMetaDataManager &metaDataManager, cursor c, size_t &len, std::string &name) {
     auto markV = *c;
     if (markV > 30 && markV < 128) {
-        return readTextString(c, len);
+        string text = readTextString(c, len);
+        int mibEnum = metaDataManager.findCharacterSetCodeByName(text);
+        if (mibEnum < 0) {
+            name = std::move(text);
+        }
+        return mibEnum;
     } else {
-        return readWellKnowCharset(metaDataManager, c, len);
+        return readWellKnowCharsetCode(c, len);
     }
 }
 
@@ -275,10 +314,10 @@ static std::string readCharset(MMSMetaDataManager &metaDataManager, cursor c, si
  *
  * 该值字符集编码的值用的是 INAN 的 MIBEnum 值
  * 参见: https://www.iana.org/assignments/character-sets/character-sets.xhtml
- *+
- * @return
+ *
+ * @return 未做字符集转换的原始字节, 以及需要转换时声明的字符集
  */
-static std::string readEncodedStringValue(MMSMetaDataManager &metaDataManager, cursor c, size_t &len) {
+static MMSHeaderValue readEncodedStringValue(const MMSMetaDataManager &metaDataManager, cursor c, size_t &len) {
     auto markV = *c;
     if (markV > 31) {
         return readTextString(c, len);
@@ -288,37 +327,48 @@ static std::string readEncodedStringValue(MMSMetaDataManager &metaDataManager, c
     long valueLength = readValueLength(c, vlen);
 
     size_t charsetLen;
-    string charset = readCharset(metaDataManager, c.offset((ptrdiff_t) vlen), charsetLen);
-
-    size_t tLen;
-    string rawText = readTextString(c.offset((ptrdiff_t) (vlen + charsetLen)), tLen);
-    len = vlen + charsetLen + tLen;
-
-    if (charsetLen + tLen != valueLength) {
+    string charsetName;
+    long mibEnum = readCharset(metaDataManager, c.offset((ptrdiff_t) vlen), charsetLen, charsetName);
+
+    // 文本按 Value-length 定界: UCS-2/UTF-16 文本中含有 0 字节, 不能按 End-of-string 截取
+    const char *text;
+    size_t textLen;
+    if (valueLength >= (long) charsetLen && c.remaining() >= vlen + (size_t) valueLength) {
+        text = c.begin + vlen + charsetLen;
+        textLen = (size_t) valueLength - charsetLen;
+        len = vlen + (size_t) valueLength;
+        if (textLen > 0 && text[textLen - 1] == 0) {
+            textLen--;
+        }
+        if (textLen > 1 && (unsigned char) text[0] == 127 && (unsigned char) text[1] > 127) {
+            text++;
+            textLen--;
+        }
+    } else {
+        cursor textCursor = c.offset((ptrdiff_t) (vlen + charsetLen));
+        textLen = scanEndOfString(textCursor);
+        text = textCursor.begin;
+        len = vlen + charsetLen + textLen + 1;
         spdlog::warn("read encode string value error, start {} , end {}", c.gOffset, c.gOffset + len);
     }
 
-    if (charset.length() > 0 && (charset == "UTF-8" || charset == "Auto")) {
-        return rawText;
+    if (mibEnum == ANY_CHARSET || mibEnum == MIB_US_ASCII || mibEnum == MIB_UTF_8
+        || (mibEnum < 0 && charsetName.empty())) {
+        return string(text, textLen);
     }
 
-    iconv_t cd;
-    cd = iconv_open("UTF-8", charset.c_str());
-    if (cd == nullptr) {
-        spdlog::warn("cannot support convert charset {} to UTF-8", charset);
-        return rawText;
+    // 只记录字符集, 由 Field::text() 在需要时再转换
+    MMSCharset charset;
+    charset.mibEnum = mibEnum;
+    if (mibEnum >= 0) {
+        charset.name = metaDataManager.findCharacterSetByCode(mibEnum);
+        if (charset.name.empty()) {
+            spdlog::warn("unknown charset {}, keep raw bytes, start {}", mibEnum, c.gOffset);
+        }
+    } else {
+        charset.name = std::move(charsetName);
     }
-
-    char *inChar = const_cast<char *>(rawText.c_str());
-
-    size_t inLen, outLen;
-    inLen = strlen(inChar);
-    outLen = inLen + 1;
-    char outText[outLen];
-    char *outChar = outText;
-    iconv(cd, &inChar, &inLen, &outChar, &outLen);
-    iconv_close(cd);
-    return {outText};
+    return {string(text, textLen), std::move(charset)};
 }
 
 /**
@@ -328,17 +378,10 @@ static std::string readEncodedStringValue(MMSMetaDataManager &metaDataManager, c
  * Extension-media = *TEXT End-of-string 用于表示在没有对应 well-know 二进制编码的媒体值
  * @return
  */
-static std::string readExtensionMedia(MMSMetaDataManager &metaDataManager, cursor c, size_t &len) {
-    std::vector<unsigned char> dat;
-
-    char tmp;
-    do {
-        tmp = *c.begin++;
-        dat.push_back(tmp);
-    } while (tmp != '\0');
-
-    len = dat.size();
-    return {dat.begin(), dat.end() - 1};
+static std::string readExtensionMedia(const MMSMetaDataManager &metaDataManager, cursor c, size_t &len) {
+    size_t n = scanEndOfString(c);
+    len = n + 1;
+    return {c.begin, n};
 }
 
 /**
@@ -347,7 +390,7 @@ static std::string readExtensionMedia(MMSMetaDataManager &metaDataManager, curso
  *
  * @return
  */
-static std::string readWellKnownMedia(MMSMetaDataManager &metaDataManager, cursor c, size_t &len) {
+static std::string readWellKnownMedia(const MMSMetaDataManager &metaDataManager, cursor c, size_t &len) {
     long mediaTypeCode = readIntegerValue(c, len);
     return metaDataManager.findContentTypeByCode(mediaTypeCode & 0x7F);
 }
@@ -368,18 +411,13 @@ static string readQuotedString(cursor c, size_t &len) {
     }
 
     cursor ac = c.offset(1);
-    std::vector<unsigned char> dat;
+    size_t n = scanEndOfString(ac);
+    len = n + 2;
 
-    char tmp;
-    do {
-        tmp = *ac.begin++;
-        dat.push_back(tmp);
-    } while (tmp != '\0');
-
-    len = dat.size() + 1;
-
-    string result = {dat.begin(), dat.end() - 1};
-    return "\"" + result + "\"";
+    string result;
+    result.reserve(n + 2);
+    result.append("\"").append(ac.begin, n).append("\"");
+    return result;
 }
 
 /**
@@ -453,11 +491,10 @@ static string readUntypedParameter(cursor c, size_t &len) {
 /**
  * 读取著名参数口令
  *  Well-known-parameter-token = Integer-value
- * @return
+ * @return 参数编码
  */
-static string readWellKnownParameterToken(MMSMetaDataManager &metaDataManager, cursor c, size_t &len) {
-    long paramToken = readIntegerValue(c, len);
-    return metaDataManager.findParamWellknownByCode(paramToken & 0x7F);
+static long readWellKnownParameterToken(cursor c, size_t &len) {
+    return readIntegerValue(c, len) & 0x7F;
 }
 
 /**
@@ -521,7 +558,7 @@ static long readDeltaSecondsValue(cursor c, size_t &len) {
  *
  * @return
  */
-static string readConstrainedEncoding(MMSMetaDataManager &metaDataManager, cursor c, size_t &len) {
+static string readConstrainedEncoding(const MMSMetaDataManager &metaDataManager, cursor c, size_t &len) {
     auto markV = *c;
     if (markV > 127) {
         auto si = readShortInteger(c, len);
@@ -539,7 +576,7 @@ static string readConstrainedEncoding(MMSMetaDataManager &metaDataManager, curso
  *
  * @return
  */
-static std::string readConstrainedMedia(MMSMetaDataManager &metaDataManager, cursor c, size_t &len) {
+static std::string readConstrainedMedia(const MMSMetaDataManager &metaDataManager, cursor c, size_t &len) {
     return readConstrainedEncoding(metaDataManager, c, len);
 }
 
@@ -556,6 +593,61 @@ static long readDateValue(cursor c, size_t &len) {
     return readLongInteger(c, len);
 }
 
+/**
+ * 著名参数值的编码类型
+ */
+enum ParamValueKind {
+    PARAM_NONE,
+    PARAM_Q_VALUE,
+    PARAM_CHARSET,
+    PARAM_VERSION_VALUE,
+    PARAM_INTEGER_VALUE,
+    PARAM_TEXT_STRING,
+    PARAM_SHORT_INTEGER,
+    PARAM_CONSTRAINED_ENCODING,
+    PARAM_DELTA_SECONDS_VALUE,
+    PARAM_NO_VALUE,
+    PARAM_TEXT_VALUE,
+    PARAM_DATE_VALUE
+};
+
+/**
+ * 按参数编码索引的值编码类型
+ * From wap-230-wsp-20010705-a.pdf  Table 38. Well-Known Parameter Assignments
+ */
+static const ParamValueKind paramValueKinds[] = {
+        PARAM_Q_VALUE,              // 0x00 Q
+        PARAM_CHARSET,              // 0x01 Charset
+        PARAM_VERSION_VALUE,        // 0x02 Level
+        PARAM_INTEGER_VALUE,        // 0x03 Type 1.1
+        PARAM_NONE,                 // 0x04
+        PARAM_TEXT_STRING,          // 0x05 Name 1.1
+        PARAM_TEXT_STRING,          // 0x06 Filename 1.1
+        PARAM_SHORT_INTEGER,        // 0x07 Differences
+        PARAM_SHORT_INTEGER,        // 0x08 Padding
+        PARAM_CONSTRAINED_ENCODING, // 0x09 Type 1.2
+        PARAM_TEXT_STRING,          // 0x0A Start 1.2
+        PARAM_TEXT_STRING,          // 0x0B Start-info 1.2
+        PARAM_TEXT_STRING,          // 0x0C Comment 1.3
+        PARAM_TEXT_STRING,          // 0x0D Domain 1.3
+        PARAM_DELTA_SECONDS_VALUE,  // 0x0E Max-Age
+        PARAM_TEXT_STRING,          // 0x0F Path 1.3
+        PARAM_NO_VALUE,             // 0x10 Secure
+        PARAM_SHORT_INTEGER,        // 0x11 SEC
+        PARAM_TEXT_VALUE,           // 0x12 MAC
+        PARAM_DATE_VALUE,           // 0x13 Creation-date
+        PARAM_DATE_VALUE,           // 0x14 Modification-date
+        PARAM_DATE_VALUE,           // 0x15 Read-date
+        PARAM_INTEGER_VALUE,        // 0x16 Size
+        PARAM_TEXT_VALUE,           // 0x17 Name 1.4
+        PARAM_TEXT_VALUE,           // 0x18 Filename 1.4
+        PARAM_TEXT_VALUE,           // 0x19 Start 1.4
+        PARAM_TEXT_VALUE,           // 0x1A Start-info 1.4
+        PARAM_TEXT_VALUE,           // 0x1B Comment 1.4
+        PARAM_TEXT_VALUE,           // 0x1C Domain 1.4
+        PARAM_TEXT_VALUE,           // 0x1D Path 1.4
+};
+
 /**
  * 读取标记的参数
  *
@@ -565,52 +657,64 @@ static long readDateValue(cursor c, size_t &len) {
  *
  * @return
  */
-static string readTypedParameter(MMSMetaDataManager &metaDataManager, cursor c, size_t &len) {
+static string readTypedParameter(const MMSMetaDataManager &metaDataManager, cursor c, size_t &len) {
     size_t wkLen, vLen;
-    string token = readWellKnownParameterToken(metaDataManager, c, wkLen);
+    long paramCode = readWellKnownParameterToken(c, wkLen);
+    const string &token = metaDataManager.findParamWellknownNameByCode(paramCode);
+    ParamValueKind kind = paramCode < (long) (sizeof(paramValueKinds) / sizeof(paramValueKinds[0]))
+                          ? paramValueKinds[paramCode] : PARAM_NONE;
 
     cursor ac = c.offset((ptrdiff_t) wkLen);
     string v;
-    if (token == "Q") {
-        v = readQValue(ac, vLen);
-    } else if (token == "Charset") {
-        v = readWellKnowCharset(metaDataManager, ac, vLen);
-    } else if (token == "Level") {
-        v = readVersionValue(ac, vLen);
-    } else if (token == "Type,1.1" || token == "Size") {
-        v = to_string(readIntegerValue(ac, vLen));
-    } else if (token == "Name,1.1" || token == "Filename,1.1" || token == "Start,1.2" || token == "Start-Info,1.2"
-               || token == "Comment,1.3" || token == "Domain,1.3" || token == "Path,1.3") {
-        v = readTextString(ac, vLen);
-    } else if (token == "Differences" || token == "Padding" || token == "SEC") {
-        v = to_string(readShortInteger(ac, vLen));
-    } else if (token == "Type,1.2") {
-        v = readConstrainedEncoding(metaDataManager, ac, vLen);
-    } else if (token == "Max-Age") {
-        v = to_string(readDeltaSecondsValue(ac, vLen));
-    } else if (token == "Secure") {
-        v = readNoValue(ac, vLen);
-    } else if (token == "MAC" || token == "Name,1.4" || token == "Filename,1.4" || token == "Start,1.4" ||
-               token == "Start-Info,1.4" || token == "Comment,1.4" || token == "Domain,1.4" || token == "Path,1.4") {
-        v = readTextValue(ac, vLen);
-    } else if (token == "Creation-Date" || token == "Modification-Date" || token == "Read-Date") {
-        v = to_string(readDateValue(ac, vLen));
-    } else {
-        v = "";
-        vLen = 0;
+    switch (kind) {
+        case PARAM_Q_VALUE:
+            v = readQValue(ac, vLen);
+            break;
+        case PARAM_CHARSET:
+            v = readWellKnowCharset(metaDataManager, ac, vLen);
+            break;
+        case PARAM_VERSION_VALUE:
+            v = readVersionValue(ac, vLen);
+            break;
+        case PARAM_INTEGER_VALUE:
+            v = to_string(readIntegerValue(ac, vLen));
+            break;
+        case PARAM_TEXT_STRING:
+            v = readTextString(ac, vLen);
+            break;
+        case PARAM_SHORT_INTEGER:
+            v = to_string(readShortInteger(ac, vLen));
+            break;
+        case PARAM_CONSTRAINED_ENCODING:
+            v = readConstrainedEncoding(metaDataManager, ac, vLen);
+            break;
+        case PARAM_DELTA_SECONDS_VALUE:
+            v = to_string(readDeltaSecondsValue(ac, vLen));
+            break;
+        case PARAM_NO_VALUE:
+            v = readNoValue(ac, vLen);
+            break;
+        case PARAM_TEXT_VALUE:
+            v = readTextValue(ac, vLen);
+            break;
+        case PARAM_DATE_VALUE:
+            v = to_string(readDateValue(ac, vLen));
+            break;
+        default:
+            vLen = 0;
+            break;
     }
 
     len = wkLen + vLen;
 
     if (v.length() == 0) {
         return token;
-    } else {
-        if (token.find(',') != string::npos) {
-            return token.substr(0, token.find_first_of(',')) + "=" + v;
-        } else {
-            return token + "=" + v;
-        }
     }
+
+    string result;
+    result.reserve(token.length() + 1 + v.length());
+    result.append(token).append("=").append(v);
+    return result;
 }
 
 /**
@@ -621,19 +725,20 @@ static string readTypedParameter(MMSMetaDataManager &metaDataManager, cursor c,
  *
  * @return
  */
-static string readParameter(MMSMetaDataManager &metaDataManager, cursor c, size_t &len) {
+static string readParameter(const MMSMetaDataManager &metaDataManager, cursor c, size_t &len) {
     auto markV = *c;
     if (markV > 31 && markV < 128) {
         return readUntypedParameter(c, len);
     } else if (markV == 31) {
         spdlog::warn("read parameter error, start {}, end {}", c.gOffset, c.gOffset);
+        len = 1;
         return "";
     } else {
         return readTypedParameter(metaDataManager, c, len);
     }
 }
 
-inline list<string> readParameters(MMSMetaDataManager &metaDataManager, cursor c, size_t &len, size_t contentLen) {
+inline list<string> readParameters(const MMSMetaDataManager &metaDataManager, cursor c, size_t &len, size_t contentLen) {
     len = 0;
     size_t tempLen;
     list<string> params;
@@ -652,7 +757,7 @@ inline list<string> readParameters(MMSMetaDataManager &metaDataManager, cursor c
  * Media-type = (Well-known-media | Extension-Media) *(Parameter)
  * @return
  */
-static std::string readMediaType(MMSMetaDataManager &metaDataManager, cursor c, size_t &len, size_t contentLen) {
+static std::string readMediaType(const MMSMetaDataManager &metaDataManager, cursor c, size_t &len, size_t contentLen) {
     auto markV = *c;
     string mediaType;
     size_t mediaTypeLen;
@@ -662,7 +767,7 @@ static std::string readMediaType(MMSMetaDataManager &metaDataManager, cursor c,
         mediaType = readWellKnownMedia(metaDataManager, c, mediaTypeLen);
     }
 
-    size_t paramContentLen = contentLen - mediaTypeLen;
+    size_t paramContentLen = contentLen > mediaTypeLen ? contentLen - mediaTypeLen : 0;
     size_t paramLen;
     list<string> param = readParameters(metaDataManager, c.offset((ptrdiff_t) mediaTypeLen), paramLen, paramContentLen);
 
@@ -685,12 +790,12 @@ static std::string readMediaType(MMSMetaDataManager &metaDataManager, cursor c,
  *
  * @return
  */
-static std::string readContentGeneralForm(MMSMetaDataManager &metaDataManager, cursor c, size_t &len) {
+static std::string readContentGeneralForm(const MMSMetaDataManager &metaDataManager, cursor c, size_t &len) {
     size_t vl;
     auto vlv = readValueLength(c, vl);
     len = vl + vlv;
     size_t mtLen;
-    return readMediaType(metaDataManager, c.offset((ptrdiff_t) vl), mtLen, vlv);
+    return readMediaType(metaDataManager, c.offset((ptrdiff_t) vl).limit(vlv), mtLen, vlv);
 }
 
 
@@ -706,7 +811,7 @@ static std::string readContentGeneralForm(MMSMetaDataManager &metaDataManager, c
  *
  * @return
  */
-static std::string readContentType(MMSMetaDataManager &metaDataManager, cursor c, size_t &len) {
+static std::string readContentType(const MMSMetaDataManager &metaDataManager, cursor c, size_t &len) {
     auto markV = *c;
     if (markV > 31) {
         return readConstrainedMedia(metaDataManager, c, len);
@@ -716,56 +821,165 @@ static std::string readContentType(MMSMetaDataManager &metaDataManager, cursor c
 }
 
 
+long MMSHexDataParser::readUIntVar(cursor c, size_t &len) {
+    return readUIntVarInteger(c, len);
+}
+
+bool MMSHexDataParser::measureUIntVar(const char *data, size_t avail, size_t &len) {
+    for (size_t i = 0; i < avail && i < 5; i++) {
+        if ((data[i] & 0x80) == 0) {
+            len = i + 1;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool MMSHexDataParser::measureHeaderValue(const char *data, size_t avail, size_t &len) {
+    if (avail == 0) {
+        return false;
+    }
+
+    auto markV = (unsigned char) *data;
+    if (markV < 31) {
+        len = 1 + markV;
+    } else if (markV == 31) {
+        size_t uvLen;
+        if (!measureUIntVar(data + 1, avail - 1, uvLen)) {
+            return false;
+        }
+        size_t lenLen;
+        len = 1 + uvLen + readUIntVarInteger({data + 1, 0, data + avail}, lenLen);
+    } else if (markV < 128) {
+        auto end = static_cast<const char *>(memchr(data, '\0', avail));
+        if (end == nullptr) {
+            return false;
+        }
+        len = end - data + 1;
+    } else {
+        len = 1;
+    }
+    return len <= avail;
+}
+
 MMSInfo MMSHexDataParser::parse() {
     MMSInfo info;
     this->parseHeader(info);
 
-    if (info.hasBody()) {
+    if (!options.headerFields.empty() || !info.hasBody()) {
+        return info;
+    }
+
+    if (options.lazyBody) {
+        const MMSMetaDataManager *manager = &metaDataManager;
+        MMSHexData hexData = mmsHexData;
+        size_t bodyPos = currentPos;
+        info.deferBody([manager, hexData, bodyPos](MMSInfo &target) {
+            MMSHexData data = hexData;
+            MMSHexDataParser(*manager, data).parseBody(target, bodyPos);
+        });
+    } else {
         this->parseBody(info);
     }
     return info;
 }
 
+void MMSHexDataParser::parseBody(MMSInfo &info, size_t bodyPos) {
+    currentPos = bodyPos;
+    parseBody(info);
+}
+
 void MMSHexDataParser::parseHeader(MMSInfo &info) {
+    bool projection = !options.headerFields.empty();
+    bitset<128> wanted;
+    // 每个收件人地址单独编码为一个 To/Cc/Bcc 字段, 这些字段要一直收集到头结束
+    bitset<128> repeatable;
+    repeatable.set(FIELD_TO);
+    repeatable.set(FIELD_CC);
+    repeatable.set(FIELD_BCC);
+    size_t wantedLeft = 0;
+    bool wantedRepeatable = false;
+    for (auto &name: options.headerFields) {
+        int code = this->metaDataManager.findFieldCodeByName(name);
+        if (code < 0) {
+            spdlog::warn("unknown header field {}", name);
+        } else if (repeatable.test(code & 0x7F)) {
+            wanted.set(code & 0x7F);
+            wantedRepeatable = true;
+        } else if (!wanted.test(code & 0x7F)) {
+            wanted.set(code & 0x7F);
+            wantedLeft++;
+        }
+    }
+    if (projection && wantedLeft == 0 && !wantedRepeatable) {
+        return;
+    }
+    if (!projection) {
+        // 完整解析时按常见的头字段数一次分配, 避免逐步扩容
+        info.reserveHeader(TYPICAL_HEADER_FIELDS);
+    }
+
     bool endOfHeader = false;
     while (!endOfHeader) {
+        if (currentPos >= this->mmsHexData.length) {
+            spdlog::warn("header is not terminated by {}, end {}", CONTENT_TYPE, currentPos);
+            return;
+        }
+
         unsigned char headerFieldCode = *(this->mmsHexData.data + currentPos);
-        string headerField = this->metaDataManager.findFieldNameByCode(headerFieldCode);
+        if (projection && !wanted.test(headerFieldCode & 0x7F)) {
+            size_t skipLen;
+            if (!measureHeaderValue(this->mmsHexData.data + currentPos + 1,
+                                    this->mmsHexData.length - currentPos - 1, skipLen)) {
+                spdlog::warn("skip header field error, start {}", currentPos);
+                return;
+            }
+            currentPos += 1 + skipLen;
+            endOfHeader = (headerFieldCode & 0x7F) == FIELD_CONTENT_TYPE;
+            continue;
+        }
+
         currentPos++;
 
-        field f;
-        f.name = {headerField, currentPos - 1, currentPos};
-        f.value = parseHeaderFieldByType(headerField);
+        size_t len;
+        field f = parseHeaderField(headerFieldCode, cursorAt(currentPos), len);
+        currentPos += len;
 
         spdlog::debug("code {}, name is : {}, value is : {} \n",
                (unsigned char) headerFieldCode,
-               headerField.c_str(),
+               f.name.value.c_str(),
                f.value.value.c_str());
 
         info.addHeaderField(f);
 
-        if (headerField == CONTENT_TYPE) {
+        if (projection && !repeatable.test(headerFieldCode & 0x7F)) {
+            wanted.reset(headerFieldCode & 0x7F);
+            if (--wantedLeft == 0 && !wantedRepeatable) {
+                return;
+            }
+        }
+
+        if ((headerFieldCode & 0x7F) == FIELD_CONTENT_TYPE) {
             endOfHeader = true;
         }
     }
 }
 
 void MMSHexDataParser::parseBody(MMSInfo &info) {
-    cursor c = {this->mmsHexData.data + currentPos, currentPos};
-    int partNum = *c;
+    size_t len;
+    long partNum = readUIntVarInteger(cursorAt(currentPos), len);
     spdlog::debug("parse body part count is {}", partNum);
-    currentPos++;
+    currentPos += len;
 
-    size_t len;
-    for (int i = partNum; i > 0; i--) {
-        info.addPart(parsePart({this->mmsHexData.data + currentPos, currentPos}, len));
+    // 每个 part 至少占用两个字节(头长度和数据长度), 避免按伪造的 part 数预留过多内存
+    info.reserveParts(min((size_t) partNum, cursorAt(currentPos).remaining() / 2));
+    for (long i = partNum; i > 0; i--) {
+        info.addPart(parsePart(cursorAt(currentPos), len));
         currentPos += len;
     }
 }
 
-MMSPart *MMSHexDataParser::parsePart(cursor c, size_t &len) {
-    auto mmsPart = new MMSPart();
-
+MMSPart MMSHexDataParser::parsePart(cursor c, size_t &len) {
     size_t partHeaderLenUsedSize;
     size_t partHeaderLen = readUIntVarInteger(c, partHeaderLenUsedSize);
 
@@ -773,66 +987,62 @@ MMSPart *MMSHexDataParser::parsePart(cursor c, size_t &len) {
     size_t parDataLenUsedSize;
     long partDataLen = readUIntVarInteger(ac, parDataLenUsedSize);
 
-    list<field> headerFields = parsePartHeaders(
-            metaDataManager,
-            c.offset((ptrdiff_t) (partHeaderLenUsedSize + parDataLenUsedSize)),
-            partHeaderLen);
-
-    char *data = new char[partDataLen];
-    memcpy(data, c.begin + partHeaderLenUsedSize + parDataLenUsedSize + partHeaderLen, partDataLen);
-    mmsPart->assignData(data, partDataLen);
-    mmsPart->assignFields(headerFields);
+    cursor hc = c.offset((ptrdiff_t) (partHeaderLenUsedSize + parDataLenUsedSize));
+    hc.require(partHeaderLen + partDataLen);
+    MMSPart mmsPart;
+    mmsPart.assignFields(parsePartHeaders(metaDataManager, hc, partHeaderLen));
+    mmsPart.assignData(c.begin + partHeaderLenUsedSize + parDataLenUsedSize + partHeaderLen, partDataLen);
 
     len = partHeaderLenUsedSize + parDataLenUsedSize + partHeaderLen + partDataLen;
     return mmsPart;
 }
 
 
-MMSV<std::string> MMSHexDataParser::parseHeaderFieldByType(const std::string &fieldName) {
-    MMSV<std::string> result = {};
-    result.start = currentPos;
-    size_t len;
-    if (fieldName == "Message-Type") {
-        result.value = parseHeaderOfXMmsMessageType({this->mmsHexData.data + currentPos, currentPos}, len);
-    } else if (fieldName == "MMS-Version") {
-        result.value = parseHeaderOfXMmsMMSVersion({this->mmsHexData.data + currentPos, currentPos}, len);
-    } else if (fieldName == "Message-Class") {
-        result.value = parseHeaderOfXMmsMessageClass({this->mmsHexData.data + currentPos, currentPos}, len);
-    } else if (fieldName == "Priority") {
-        result.value = parseHeaderOfXMmsPriority({this->mmsHexData.data + currentPos, currentPos}, len);
-    } else if (fieldName == "Delivery-Report") {
-        result.value = parseHeaderOfXMmsDeliveryReport({this->mmsHexData.data + currentPos, currentPos}, len);
-    } else if (fieldName == "Read-Reply") {
-        result.value = parseHeaderOfXMmsReadReply({this->mmsHexData.data + currentPos, currentPos}, len);
-    } else if (fieldName == "Transaction-Id") {
-        result.value = parseHeaderOfXMmsTransactionId({this->mmsHexData.data + currentPos, currentPos}, len);
-    } else if (fieldName == "Message-ID") {
-        result.value = parseHeaderOfMessageId({this->mmsHexData.data + currentPos, currentPos}, len);
-    } else if (fieldName == "Date") {
-        result.value = parseHeaderOfDate({this->mmsHexData.data + currentPos, currentPos}, len);
-    } else if (fieldName == "To") {
-        result.value = parseHeaderOfTo({this->mmsHexData.data + currentPos, currentPos}, len);
-    } else if (fieldName == "From") {
-        result.value = parseHeaderOfFrom({this->mmsHexData.data + currentPos, currentPos}, len);
-    } else if (fieldName == "Subject") {
-        result.value = parseHeaderOfSubject({this->mmsHexData.data + currentPos, currentPos}, len);
-    } else if (fieldName == "Cc") {
-        result.value = parseHeaderOfCc({this->mmsHexData.data + currentPos, currentPos}, len);
-    } else if (fieldName == "Content-Type") {
-        result.value = parseHeaderOfContentType({this->mmsHexData.data + currentPos, currentPos}, len);
-    } else if (fieldName == "Content-Location") {
-        result.value = parseHeaderOfXMmsContentLocation({this->mmsHexData.data + currentPos, currentPos}, len);
-    } else if (fieldName == "Expiry") {
-        result.value = parseHeaderOfXMmsMMSExpiry({this->mmsHexData.data + currentPos, currentPos}, len);
-    } else if (fieldName == "Message-Size") {
-        result.value = parseHeaderOfXMmsMMSMessageSize({this->mmsHexData.data + currentPos, currentPos}, len);
-    } else {
-        len = 1;
+const MMSHexDataParser::HeaderFieldDecoder MMSHexDataParser::headerFieldDecoders[128] = {
+        nullptr,                                             // 0x00
+        nullptr,                                             // 0x01 Bcc
+        &MMSHexDataParser::parseHeaderOfCc,                  // 0x02 Cc
+        &MMSHexDataParser::parseHeaderOfXMmsContentLocation, // 0x03 Content-Location
+        &MMSHexDataParser::parseHeaderOfContentType,         // 0x04 Content-Type
+        &MMSHexDataParser::parseHeaderOfDate,                // 0x05 Date
+        &MMSHexDataParser::parseHeaderOfXMmsDeliveryReport,  // 0x06 Delivery-Report
+        nullptr,                                             // 0x07 Delivery-Time
+        &MMSHexDataParser::parseHeaderOfXMmsMMSExpiry,       // 0x08 Expiry
+        &MMSHexDataParser::parseHeaderOfFrom,                // 0x09 From
+        &MMSHexDataParser::parseHeaderOfXMmsMessageClass,    // 0x0A Message-Class
+        &MMSHexDataParser::parseHeaderOfMessageId,           // 0x0B Message-ID
+        &MMSHexDataParser::parseHeaderOfXMmsMessageType,     // 0x0C Message-Type
+        &MMSHexDataParser::parseHeaderOfXMmsMMSVersion,      // 0x0D MMS-Version
+        &MMSHexDataParser::parseHeaderOfXMmsMMSMessageSize,  // 0x0E Message-Size
+        &MMSHexDataParser::parseHeaderOfXMmsPriority,        // 0x0F Priority
+        &MMSHexDataParser::parseHeaderOfXMmsReadReply,       // 0x10 Read-Reply
+        nullptr,                                             // 0x11 Report-Allowed
+        nullptr,                                             // 0x12 Response-Status
+        nullptr,                                             // 0x13 Response-Text
+        nullptr,                                             // 0x14 Sender-Visibility
+        nullptr,                                             // 0x15 Status
+        &MMSHexDataParser::parseHeaderOfSubject,             // 0x16 Subject
+        &MMSHexDataParser::parseHeaderOfTo,                  // 0x17 To
+        &MMSHexDataParser::parseHeaderOfXMmsTransactionId,   // 0x18 Transaction-Id
+};
+
+field MMSHexDataParser::parseHeaderField(unsigned char fieldCode, cursor c, size_t &len) {
+    field f;
+    f.name = {metaDataManager.findFieldNameByCode(fieldCode), c.gOffset - 1, c.gOffset};
+    f.value.start = c.gOffset;
+
+    HeaderFieldDecoder decoder = headerFieldDecoders[fieldCode & 0x7F];
+    if (decoder != nullptr) {
+        MMSHeaderValue value = (this->*decoder)(c, len);
+        f.value.value = std::move(value.text);
+        f.charset = std::move(value.charset);
+        f.typed = value.typed;
+    } else if (!measureHeaderValue(c.begin, c.remaining(), len)) {
+        throw MMSParseError("header field truncated, start " + to_string(c.gOffset));
     }
 
-    result.end = currentPos + len;
-    currentPos += len;
-    return result;
+    f.value.end = c.gOffset + len;
+    return f;
 }
 
 
@@ -852,9 +1062,9 @@ MMSV<std::string> MMSHexDataParser::parseHeaderFieldByType(const std::string &fi
  *
  * @return
  */
-std::string MMSHexDataParser::parseHeaderOfXMmsMessageType(cursor c, size_t &len) {
+MMSHeaderValue MMSHexDataParser::parseHeaderOfXMmsMessageType(cursor c, size_t &len) {
     len = 1;
-    return metaDataManager.findMessageTypeNameByCode(*c);
+    return MMSTypedValue(*c, metaDataManager.findMessageTypeNameByCode(*c));
 }
 
 /**
@@ -868,7 +1078,7 @@ std::string MMSHexDataParser::parseHeaderOfXMmsMessageType(cursor c, size_t &len
  *
  * @return
  */
-std::string MMSHexDataParser::parseHeaderOfXMmsMMSVersion(cursor c, size_t &len) {
+MMSHeaderValue MMSHexDataParser::parseHeaderOfXMmsMMSVersion(cursor c, size_t &len) {
     int number = readShortInteger(c, len);
     return std::to_string(number / 0x10) + "." + std::to_string(number % 0x10);
 }
@@ -887,11 +1097,11 @@ std::string MMSHexDataParser::parseHeaderOfXMmsMMSVersion(cursor c, size_t &len)
  *
  * @return
  */
-std::string MMSHexDataParser::parseHeaderOfXMmsMessageClass(cursor c, size_t &len) {
+MMSHeaderValue MMSHexDataParser::parseHeaderOfXMmsMessageClass(cursor c, size_t &len) {
     auto markV = *c;
     if (markV > 127) {
         len = 1;
-        return metaDataManager.findMessageClassByCode(markV);
+        return MMSTypedValue(markV, metaDataManager.findMessageClassByCode(markV));
     } else {
         return readTokenText(c, len);
     }
@@ -907,9 +1117,9 @@ std::string MMSHexDataParser::parseHeaderOfXMmsMessageClass(cursor c, size_t &le
  *
  * @return
  */
-std::string MMSHexDataParser::parseHeaderOfXMmsPriority(cursor c, size_t &len) {
+MMSHeaderValue MMSHexDataParser::parseHeaderOfXMmsPriority(cursor c, size_t &len) {
     len = 1;
-    return metaDataManager.findPriorityByCode(*c);
+    return MMSTypedValue(*c, metaDataManager.findPriorityByCode(*c));
 }
 
 /**
@@ -921,9 +1131,9 @@ std::string MMSHexDataParser::parseHeaderOfXMmsPriority(cursor c, size_t &len) {
  *
  * @return
  */
-std::string MMSHexDataParser::parseHeaderOfXMmsDeliveryReport(cursor c, size_t &len) {
+MMSHeaderValue MMSHexDataParser::parseHeaderOfXMmsDeliveryReport(cursor c, size_t &len) {
     len = 1;
-    return metaDataManager.findDeliveryReportByCode(*c);
+    return MMSTypedValue(*c, metaDataManager.findDeliveryReportByCode(*c));
 }
 
 /**
@@ -935,9 +1145,9 @@ std::string MMSHexDataParser::parseHeaderOfXMmsDeliveryReport(cursor c, size_t &
  *
  * @return
  */
-std::string MMSHexDataParser::parseHeaderOfXMmsReadReply(cursor c, size_t &len) {
+MMSHeaderValue MMSHexDataParser::parseHeaderOfXMmsReadReply(cursor c, size_t &len) {
     len = 1;
-    return metaDataManager.findReadReplyByCode(*c);
+    return MMSTypedValue(*c, metaDataManager.findReadReplyByCode(*c));
 }
 
 /**
@@ -947,7 +1157,7 @@ std::string MMSHexDataParser::parseHeaderOfXMmsReadReply(cursor c, size_t &len)
  *
  * @return
  */
-std::string MMSHexDataParser::parseHeaderOfXMmsTransactionId(cursor c, size_t &len) {
+MMSHeaderValue MMSHexDataParser::parseHeaderOfXMmsTransactionId(cursor c, size_t &len) {
     return readTextString(c, len);
 }
 
@@ -959,7 +1169,7 @@ std::string MMSHexDataParser::parseHeaderOfXMmsTransactionId(cursor c, size_t &l
  *
  * @return
  */
-std::string MMSHexDataParser::parseHeaderOfMessageId(cursor c, size_t &len) {
+MMSHeaderValue MMSHexDataParser::parseHeaderOfMessageId(cursor c, size_t &len) {
     return readTextString(c, len);
 }
 
@@ -971,9 +1181,8 @@ std::string MMSHexDataParser::parseHeaderOfMessageId(cursor c, size_t &len) {
  *
  * @return
  */
-std::string MMSHexDataParser::parseHeaderOfDate(cursor c, size_t &len) {
-    long data = readDateValue(c, len);
-    return to_string(data);
+MMSHeaderValue MMSHexDataParser::parseHeaderOfDate(cursor c, size_t &len) {
+    return MMSTypedValue(MMS_VALUE_TIMESTAMP, readDateValue(c, len));
 }
 
 /**
@@ -984,7 +1193,7 @@ std::string MMSHexDataParser::parseHeaderOfDate(cursor c, size_t &len) {
  *
  * @return
  */
-std::string MMSHexDataParser::parseHeaderOfTo(cursor c, size_t &len) {
+MMSHeaderValue MMSHexDataParser::parseHeaderOfTo(cursor c, size_t &len) {
     return readEncodedStringValue(metaDataManager, c, len);
 }
 
@@ -998,7 +1207,7 @@ std::string MMSHexDataParser::parseHeaderOfTo(cursor c, size_t &len) {
  *
  * @return
  */
-std::string MMSHexDataParser::parseHeaderOfFrom(cursor c, size_t &len) {
+MMSHeaderValue MMSHexDataParser::parseHeaderOfFrom(cursor c, size_t &len) {
     size_t vLen;
     long vl = readValueLength(c, vLen);
     cursor ac = c.offset(ptrdiff_t(vLen));
@@ -1008,7 +1217,7 @@ std::string MMSHexDataParser::parseHeaderOfFrom(cursor c, size_t &len) {
         return "[Placeholder]";
     } else if (markV == 128) {
         size_t enLen;
-        string result = readEncodedStringValue(metaDataManager, ac.offset(1), enLen);
+        MMSHeaderValue result = readEncodedStringValue(metaDataManager, ac.offset(1), enLen);
         len = vLen + 1 + enLen;
         return result;
     } else {
@@ -1024,7 +1233,7 @@ std::string MMSHexDataParser::parseHeaderOfFrom(cursor c, size_t &len) {
  *
  * @return
  */
-std::string MMSHexDataParser::parseHeaderOfCc(cursor c, size_t &len) {
+MMSHeaderValue MMSHexDataParser::parseHeaderOfCc(cursor c, size_t &len) {
     return readEncodedStringValue(metaDataManager, c, len);
 }
 
@@ -1036,12 +1245,12 @@ std::string MMSHexDataParser::parseHeaderOfCc(cursor c, size_t &len) {
  *
  * @return
  */
-std::string MMSHexDataParser::parseHeaderOfSubject(cursor c, size_t &len) {
+MMSHeaderValue MMSHexDataParser::parseHeaderOfSubject(cursor c, size_t &len) {
     return readEncodedStringValue(metaDataManager, c, len);
 }
 
 
-std::string MMSHexDataParser::parseHeaderOfContentType(cursor c, size_t &len) {
+MMSHeaderValue MMSHexDataParser::parseHeaderOfContentType(cursor c, size_t &len) {
     return readContentType(metaDataManager, c, len);
 }
 
@@ -1052,10 +1261,25 @@ std::string MMSHexDataParser::parseHeaderOfContentType(cursor c, size_t &len) {
  *
  * @return
  */
-std::string MMSHexDataParser::parseHeaderOfXMmsContentLocation(cursor c, size_t &len) {
+MMSHeaderValue MMSHexDataParser::parseHeaderOfXMmsContentLocation(cursor c, size_t &len) {
     return readUriValue(c, len);
 }
 
+/**
+ * 把无法解码的字节格式化为十六进制文本, 如 0x82AABB, 避免把二进制数据当作文本输出
+ */
+static string formatHexOctets(const char *data, size_t size) {
+    static const char digits[] = "0123456789ABCDEF";
+    string out = "0x";
+    out.reserve(2 + size * 2);
+    for (size_t i = 0; i < size; i++) {
+        auto octet = (unsigned char) data[i];
+        out.push_back(digits[octet >> 4]);
+        out.push_back(digits[octet & 0x0F]);
+    }
+    return out;
+}
+
 /**
  * 读取 MMS 有效期
  *
@@ -1065,9 +1289,9 @@ std::string MMSHexDataParser::parseHeaderOfXMmsContentLocation(cursor c, size_t
  *
  * Length of time the message will be available. The field has only one format, interval.
  *
- * @return
+ * @return 绝对时间为 MMS_VALUE_TIMESTAMP, 相对时间为 MMS_VALUE_DELTA, 未知 token 为 Value-length 范围内字节的十六进制文本
  */
-std::string MMSHexDataParser::parseHeaderOfXMmsMMSExpiry(cursor c, size_t &len) {
+MMSHeaderValue MMSHexDataParser::parseHeaderOfXMmsMMSExpiry(cursor c, size_t &len) {
     size_t vl;
     long vll = readValueLength(c, vl);
 
@@ -1078,14 +1302,19 @@ std::string MMSHexDataParser::parseHeaderOfXMmsMMSExpiry(cursor c, size_t &len)
         size_t dateLen;
         long timestamp = readDateValue(ac, dateLen);
         len = vl + 1 + dateLen;
-        return to_string(timestamp);
+        return MMSTypedValue(MMS_VALUE_TIMESTAMP, timestamp);
     } else if (markV == 129) {
         ac = c.offset((ptrdiff_t) (vl + 1));
-        long delta = readDeltaSecondsValue(c, len);
-        return string("+") + to_string(delta);
+        size_t deltaLen;
+        long delta = readDeltaSecondsValue(ac, deltaLen);
+        len = vl + 1 + deltaLen;
+        return MMSTypedValue(MMS_VALUE_DELTA, delta);
     } else {
-        len = vl;
-        return "0";
+        // 未知的 token, 值无法解码, 以十六进制文本保留 Value-length 范围内的字节
+        ac.require((size_t) vll);
+        len = vl + (size_t) vll;
+        spdlog::warn("unknown expiry token {}, start {}", (unsigned char) markV, c.gOffset);
+        return formatHexOctets(ac.begin, (size_t) vll);
     }
 }
 
@@ -1100,30 +1329,32 @@ std::string MMSHexDataParser::parseHeaderOfXMmsMMSExpiry(cursor c, size_t &len)
  *
  * @return
  */
-std::string MMSHexDataParser::parseHeaderOfXMmsMMSMessageSize(cursor c, size_t &len) {
-    return to_string(readLongInteger(c, len));
+MMSHeaderValue MMSHexDataParser::parseHeaderOfXMmsMMSMessageSize(cursor c, size_t &len) {
+    return MMSTypedValue(MMS_VALUE_INTEGER, readLongInteger(c, len));
 }
 
-std::list<field>
-MMSHexDataParser::parsePartHeaders(MMSMetaDataManager &mmsMetaDataManager, cursor c, const size_t &contentLen) {
-    list<field> fields;
+MMSPartHeaderList
+MMSHexDataParser::parsePartHeaders(const MMSMetaDataManager &mmsMetaDataManager, cursor c, const size_t &contentLen) {
+    MMSPartHeaderList fields;
+    c = c.limit(contentLen);
 
     field f;
-    f.name = {"Content-Type", c.gOffset, c.gOffset};
+    static const MMSName contentTypeName = MMSName::intern(CONTENT_TYPE);
+    f.name = {contentTypeName, c.gOffset, c.gOffset};
     size_t contentTypeLen;
     string contentType = readContentType(metaDataManager, c, contentTypeLen);
     f.value = {contentType, c.gOffset, c.gOffset + contentTypeLen};
     fields.push_back(f);
 
     size_t usedLen = contentTypeLen;
-    while ((contentLen - usedLen) > 0) {
+    while (usedLen < contentLen) {
         field tf;
 
         size_t siLen;
         long fieldParmaCode = readShortInteger(c.offset((ptrdiff_t) usedLen), siLen);
         usedLen += siLen;
 
-        string fieldName = metaDataManager.findParamFieldByCode(fieldParmaCode);
+        MMSName fieldName = metaDataManager.findParamFieldByCode(fieldParmaCode);
         tf.name = {fieldName, c.gOffset + usedLen, c.gOffset + usedLen + siLen};
 
         size_t vLen;
@@ -1,67 +1,160 @@
 #ifndef FREEMMS_MMSHEXDATAPARSER_H
 #define FREEMMS_MMSHEXDATAPARSER_H
 
+#include <vector>
 #include <MMSHexData.h>
+#include <MMSParseOptions.h>
 #include "MMSMetaDataManager.h"
 #include "MMSParserCursor.h"
 #include "MMSInfo.h"
 
+/**
+ * MMS 头字段编码, 取值为去掉最高位后的编码
+ * From oma-ts-mms-enc-v1_3.pdf  7.4 Header Field Names and Assigned Numbers
+ */
+enum MMSHeaderFieldCode {
+    FIELD_BCC = 0x01,
+    FIELD_CC = 0x02,
+    FIELD_CONTENT_LOCATION = 0x03,
+    FIELD_CONTENT_TYPE = 0x04,
+    FIELD_DATE = 0x05,
+    FIELD_DELIVERY_REPORT = 0x06,
+    FIELD_DELIVERY_TIME = 0x07,
+    FIELD_EXPIRY = 0x08,
+    FIELD_FROM = 0x09,
+    FIELD_MESSAGE_CLASS = 0x0A,
+    FIELD_MESSAGE_ID = 0x0B,
+    FIELD_MESSAGE_TYPE = 0x0C,
+    FIELD_MMS_VERSION = 0x0D,
+    FIELD_MESSAGE_SIZE = 0x0E,
+    FIELD_PRIORITY = 0x0F,
+    FIELD_READ_REPLY = 0x10,
+    FIELD_REPORT_ALLOWED = 0x11,
+    FIELD_RESPONSE_STATUS = 0x12,
+    FIELD_RESPONSE_TEXT = 0x13,
+    FIELD_SENDER_VISIBILITY = 0x14,
+    FIELD_STATUS = 0x15,
+    FIELD_SUBJECT = 0x16,
+    FIELD_TO = 0x17,
+    FIELD_TRANSACTION_ID = 0x18
+};
+
+/**
+ * 头字段值的解码结果
+ * 文本类字段只有 text, Encoded-string-value 同时带有声明的字符集, 数值和枚举类字段只有 typed
+ */
+struct MMSHeaderValue {
+    std::string text;
+    MMSCharset charset;
+    MMSTypedValue typed;
+
+    MMSHeaderValue(const char *text) : text(text) {}
+
+    MMSHeaderValue(std::string text) : text(std::move(text)) {}
+
+    MMSHeaderValue(std::string text, MMSCharset charset) : text(std::move(text)), charset(std::move(charset)) {}
+
+    MMSHeaderValue(const MMSTypedValue &typed) : typed(typed) {}
+};
+
 class MMSHexDataParser {
 private:
-    MMSMetaDataManager &metaDataManager;
+    typedef MMSHeaderValue (MMSHexDataParser::*HeaderFieldDecoder)(cursor c, size_t &len);
+
+    /**
+     * 按头字段编码索引的解码函数表, 未实现的字段为 nullptr
+     */
+    static const HeaderFieldDecoder headerFieldDecoders[128];
+
+    const MMSMetaDataManager &metaDataManager;
     MMSHexData &mmsHexData;
+    MMSParseOptions options;
     size_t currentPos;
 
     void parseHeader(MMSInfo &info);
 
     void parseBody(MMSInfo &info);
 
-    std::string parseHeaderOfXMmsMessageType(cursor c, size_t &len);
+    MMSHeaderValue parseHeaderOfXMmsMessageType(cursor c, size_t &len);
 
-    static std::string parseHeaderOfXMmsMMSVersion(cursor c, size_t &len);
+    MMSHeaderValue parseHeaderOfXMmsMMSVersion(cursor c, size_t &len);
 
-    std::string parseHeaderOfXMmsMessageClass(cursor c, size_t &len);
+    MMSHeaderValue parseHeaderOfXMmsMessageClass(cursor c, size_t &len);
 
-    std::string parseHeaderOfXMmsPriority(cursor c, size_t &len);
+    MMSHeaderValue parseHeaderOfXMmsPriority(cursor c, size_t &len);
 
-    std::string parseHeaderOfXMmsDeliveryReport(cursor c, size_t &len);
+    MMSHeaderValue parseHeaderOfXMmsDeliveryReport(cursor c, size_t &len);
 
-    std::string parseHeaderOfXMmsReadReply(cursor c, size_t &len);
+    MMSHeaderValue parseHeaderOfXMmsReadReply(cursor c, size_t &len);
 
-    static std::string parseHeaderOfXMmsTransactionId(cursor c, size_t &len);
+    MMSHeaderValue parseHeaderOfXMmsTransactionId(cursor c, size_t &len);
 
-    static std::string parseHeaderOfMessageId(cursor c, size_t &len);
+    MMSHeaderValue parseHeaderOfMessageId(cursor c, size_t &len);
 
-    static std::string parseHeaderOfDate(cursor c, size_t &len);
+    MMSHeaderValue parseHeaderOfDate(cursor c, size_t &len);
 
-    std::string parseHeaderOfTo(cursor c, size_t &len);
+    MMSHeaderValue parseHeaderOfTo(cursor c, size_t &len);
 
-    std::string parseHeaderOfFrom(cursor c, size_t &len);
+    MMSHeaderValue parseHeaderOfFrom(cursor c, size_t &len);
 
-    std::string parseHeaderOfSubject(cursor c, size_t &len);
+    MMSHeaderValue parseHeaderOfSubject(cursor c, size_t &len);
 
-    std::string parseHeaderOfCc(cursor c, size_t &len);
+    MMSHeaderValue parseHeaderOfCc(cursor c, size_t &len);
 
-    std::string parseHeaderOfContentType(cursor c, size_t &len);
+    MMSHeaderValue parseHeaderOfContentType(cursor c, size_t &len);
 
-    static std::string parseHeaderOfXMmsContentLocation(cursor c, size_t &len);
+    MMSHeaderValue parseHeaderOfXMmsContentLocation(cursor c, size_t &len);
 
-    static std::string parseHeaderOfXMmsMMSExpiry(cursor c, size_t &len);
+    MMSHeaderValue parseHeaderOfXMmsMMSExpiry(cursor c, size_t &len);
 
-    static std::string parseHeaderOfXMmsMMSMessageSize(cursor c, size_t &len);
+    MMSHeaderValue parseHeaderOfXMmsMMSMessageSize(cursor c, size_t &len);
 
-    MMSPart* parsePart(cursor c, size_t &len);
+    MMSPart parsePart(cursor c, size_t &len);
 
-    std::list<field> parsePartHeaders(MMSMetaDataManager &mmsMetaDataManager, cursor c, const size_t &contentLen);
+    cursor cursorAt(size_t pos) const {
+        return {mmsHexData.data + pos, pos, mmsHexData.data + mmsHexData.length};
+    }
 
 public:
-    MMSHexDataParser(MMSMetaDataManager &metaDataManager, MMSHexData &mmsHexData) : metaDataManager(metaDataManager),
+    MMSHexDataParser(const MMSMetaDataManager &metaDataManager, MMSHexData &mmsHexData) : metaDataManager(metaDataManager),
                                                                                     mmsHexData(mmsHexData),
                                                                                     currentPos(0) {}
 
+    MMSHexDataParser(const MMSMetaDataManager &metaDataManager, MMSHexData &mmsHexData, const MMSParseOptions &options)
+            : metaDataManager(metaDataManager),
+              mmsHexData(mmsHexData),
+              options(options),
+              currentPos(0) {}
+
     MMSInfo parse();
 
-    MMSV<std::string> parseHeaderFieldByType(const std::string &basicString);
+    /**
+     * 从 bodyPos 处开始解析 body, 用于延迟解码 part 表
+     */
+    void parseBody(MMSInfo &info, size_t bodyPos);
+
+    /**
+     * 解码完整的头字段, c 指向字段值, 字段编码位于 c 之前的一个字节
+     * 按头字段编码直接查表解码, 未实现的字段按 WSP 通用编码规则跳过
+     * Encoded-string-value 保留原始字节并记录字符集, 见 Field
+     */
+    field parseHeaderField(unsigned char fieldCode, cursor c, size_t &len);
+
+    MMSPartHeaderList parsePartHeaders(const MMSMetaDataManager &mmsMetaDataManager, cursor c, const size_t &contentLen);
+
+    static long readUIntVar(cursor c, size_t &len);
+
+    /**
+     * 计算 uintvar 占用的字节数, 可用数据不足时返回 false
+     */
+    static bool measureUIntVar(const char *data, size_t avail, size_t &len);
+
+    /**
+     * 按 WSP 通用编码规则计算头字段值占用的字节数, 不做解码
+     * 首字节 0-30 为 Short-length, 31 为 Length-quote Length, 32-127 为以 0 结尾的字符串, 128-255 为单字节
+     * 可用数据不足时返回 false
+     */
+    static bool measureHeaderValue(const char *data, size_t avail, size_t &len);
 };
 
 
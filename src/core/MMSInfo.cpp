@@ -1,22 +1,37 @@
 #include "MMSInfo.h"
 #include <spdlog/spdlog.h>
-#include <list>
 #include <algorithm>
 #include <sstream>
+#include <type_traits>
 
 using namespace std;
 
-MMSInfo::MMSInfo() : _header(new std::list<field>()), _body(new std::list<MMSPart *>) {
+static_assert(std::is_nothrow_move_constructible<MMSPart>::value, "MMSPart must be nothrow movable");
+static_assert(std::is_nothrow_move_constructible<MMSHeaderList>::value, "header list must be nothrow movable");
+
+MMSInfo::MMSInfo() = default;
+
+MMSInfo::MMSInfo(MMSInfo &&info) noexcept
+        : _header(std::move(info._header)),
+          _body(std::move(info._body)),
+          _data(std::move(info._data)),
+          _metaData(std::move(info._metaData)),
+          _bodyLoader(std::move(info._bodyLoader)) {
 }
 
-MMSInfo::~MMSInfo() {
-    delete _header;
-    for (auto &part: *_body) {
-        delete part;
+MMSInfo &MMSInfo::operator=(MMSInfo &&info) noexcept {
+    if (this != &info) {
+        _header = std::move(info._header);
+        _body = std::move(info._body);
+        _data = std::move(info._data);
+        _metaData = std::move(info._metaData);
+        _bodyLoader = std::move(info._bodyLoader);
     }
-    delete _body;
+    return *this;
 }
 
+MMSInfo::~MMSInfo() = default;
+
 #define NLRF "\r\n"
 #define PART_SEPARATOR "----------------------------part"
 #define PART_SEPARATOR_END "----------------------------part--"
@@ -25,22 +40,22 @@ MMSInfo::~MMSInfo() {
 std::string MMSInfo::toPlain(bool includeBody) {
     stringstream ss;
 
-    for (auto &f: *_header) {
-        ss << f.name.value << ": " << f.value.value << NLRF;
+    for (auto &f: _header) {
+        ss << f.name.value << ": " << f.text() << NLRF;
     }
 
     ss << NLRF;
 
     if (hasBody()) {
-        for (auto &part: *_body) {
+        for (auto &part: *body()) {
             ss << PART_SEPARATOR << NLRF;
 
-            for (auto &f: part->header()) {
-                ss << f.name.value << ": " << f.value.value << NLRF;
+            for (auto &f: part.header()) {
+                ss << f.name.value << ": " << f.text() << NLRF;
             }
-            ss << "Content-Length: " << part->dataLen() << NLRF;
+            ss << "Content-Length: " << part.dataLen() << NLRF;
             if (includeBody) {
-                ss.write(part->data(), part->dataLen());
+                ss.write(part.data(), part.dataLen());
                 ss << NLRF;
             }
         }
@@ -52,20 +67,31 @@ std::string MMSInfo::toPlain(bool includeBody) {
 }
 
 bool MMSInfo::hasBody() {
-    auto it = find_if(_header->begin(), _header->end(), [](const field &rhs) -> bool {
-        return rhs.name.value == "Message-Type" && rhs.value.value == "M-Retrieve-Conf";
+    auto it = find_if(_header.begin(), _header.end(), [](const field &rhs) -> bool {
+        return rhs.name.value == "Message-Type" && rhs.typed.symbol == "M-Retrieve-Conf";
     });
-    return it != _header->end();
+    return it != _header.end();
 }
 
-void MMSInfo::addPart(MMSPart *part) {
-    this->_body->push_back(part);
+void MMSInfo::addPart(MMSPart part) {
+    this->_body.push_back(std::move(part));
 }
 
-std::list<field> *MMSInfo::header() const {
-    return _header;
+const MMSHeaderList *MMSInfo::header() const {
+    return &_header;
 }
 
-std::list<MMSPart *> *MMSInfo::body() const {
-    return _body;
+const std::vector<MMSPart> *MMSInfo::body() {
+    if (_bodyLoader) {
+        auto bodyLoader = std::move(_bodyLoader);
+        _bodyLoader = nullptr;
+        try {
+            bodyLoader(*this);
+        } catch (...) {
+            _body.clear();
+            _bodyLoader = std::move(bodyLoader);
+            throw;
+        }
+    }
+    return &_body;
 }
@@ -1,7 +1,9 @@
 #ifndef FREEMMS_MMSINFO_H
 #define FREEMMS_MMSINFO_H
 
-#include <list>
+#include <functional>
+#include <vector>
+#include <memory>
 #include <string>
 #include <spdlog/spdlog.h>
 
@@ -9,29 +11,83 @@
 #include "MMSPart.h"
 #include "Field.h"
 
+class MMSMetaDataManager;
+
+/**
+ * 解析结果, 只能移动不能复制. 移动时转移 part 表和缓冲区的所有权; 头字段在堆上时同样只转移指针,
+ * 不超过内联容量(投影解析的少数字段)时逐个移动这些字段
+ */
 class MMSInfo {
 public:
     MMSInfo();
 
+    MMSInfo(const MMSInfo &info) = delete;
+
+    MMSInfo &operator=(const MMSInfo &info) = delete;
+
+    MMSInfo(MMSInfo &&info) noexcept;
+
+    MMSInfo &operator=(MMSInfo &&info) noexcept;
+
     ~MMSInfo();
 
+    /**
+     * 延迟解码模式下会先解码 part 表, 数据被截断时抛出 MMSParseError
+     */
     std::string toPlain(bool includeBody);
 
     bool hasBody();
 
-    void addHeaderField(const field &f) {
-        _header->push_back(f);
+    void addHeaderField(field f) {
+        _header.push_back(std::move(f));
     }
 
-    void addPart(MMSPart *part);
+    void addPart(MMSPart part);
+
+    void reserveHeader(size_t count) {
+        _header.reserve(count);
+    }
 
-    std::list<field> *header() const;
+    void reserveParts(size_t count) {
+        _body.reserve(count);
+    }
 
-    std::list<MMSPart *> *body() const;
+    const MMSHeaderList *header() const;
+
+    /**
+     * 返回 part 列表, 延迟解码模式下第一次调用时才解码 part 表, 因此不是 const 方法,
+     * 多线程共享同一个 MMSInfo 时需要由调用方同步.
+     * 数据被截断时抛出 MMSParseError, part 表保持为空, 再次调用会重新尝试解码
+     */
+    const std::vector<MMSPart> *body();
+
+    /**
+     * 设置延迟解码 part 表的回调, 由解析器在 lazyBody 模式下调用
+     */
+    void deferBody(std::function<void(MMSInfo &)> bodyLoader) {
+        _bodyLoader = std::move(bodyLoader);
+    }
+
+    /**
+     * 持有原始 PDU 缓冲区, 各 MMSPart 的 data() 直接指向该缓冲区, 不做拷贝
+     */
+    void holdData(std::shared_ptr<const char> data) {
+        _data = std::move(data);
+    }
+
+    /**
+     * 持有解析时使用的元数据版本, 结果中的名字指向其字符串池, 也保证延迟解码时元数据重新加载不影响本次结果
+     */
+    void holdMetaData(std::shared_ptr<const MMSMetaDataManager> metaData) {
+        _metaData = std::move(metaData);
+    }
 
 private:
-    std::list<field> *_header;
-    std::list<MMSPart *> *_body;
+    MMSHeaderList _header;
+    std::vector<MMSPart> _body;
+    std::shared_ptr<const char> _data;
+    std::shared_ptr<const MMSMetaDataManager> _metaData;
+    std::function<void(MMSInfo &)> _bodyLoader;
 
 };
 
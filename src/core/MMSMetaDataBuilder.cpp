@@ -0,0 +1,137 @@
+#include "MMSMetaDataBuilder.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include "json.hpp"
+#include "MMSPerfectHash.h"
+
+using namespace std;
+using namespace nlohmann;
+
+const char *const MMSMetaDataBuilder::META_FILES[] = {
+        "character_sets_mibenum",
+        "mms_header_field",
+        "mms_option_content_type",
+        "mms_option_delivery_report",
+        "mms_option_message_class",
+        "mms_option_message_type",
+        "mms_option_priority",
+        "mms_option_read_reply",
+        "mms_option_report_allowed",
+        "mms_option_response_status",
+        "mms_param_field",
+        "mms_param_wellknown",
+};
+
+const size_t MMSMetaDataBuilder::META_FILE_COUNT = sizeof(META_FILES) / sizeof(META_FILES[0]);
+
+uint32_t MMSMetaDataBuilder::intern(const std::string &str) {
+    auto it = stringOffsets.find(str);
+    if (it != stringOffsets.end()) {
+        return it->second;
+    }
+
+    auto offset = (uint32_t) stringPool.size();
+    stringPool.insert(stringPool.end(), str.begin(), str.end());
+    stringPool.push_back('\0');
+    stringOffsets.emplace(str, offset);
+    return offset;
+}
+
+void MMSMetaDataBuilder::addJsonFile(const std::string &configDir, const char *file) {
+    string filePath = configDir + "/" + file + ".json";
+    ifstream s(filePath);
+    if (!s.is_open()) {
+        throw runtime_error("file not exist " + filePath);
+    }
+
+    json dataJson;
+    s >> dataJson;
+    vector<Config> configs;
+    for (auto &obj: dataJson) {
+        Config config;
+        config.name = obj.at("NAME").get<string>();
+        config.version = obj.contains("VERSION") ? obj.at("VERSION").get<string>() : "";
+        config.value = obj.at("VALUE").get<int>();
+        configs.push_back(config);
+    }
+    addTable(file, configs);
+}
+
+void MMSMetaDataBuilder::addTable(const char *file, const std::vector<Config> &configs) {
+    MetaLayoutTable table = {};
+    strncpy(table.file, file, sizeof(table.file) - 1);
+    table.firstEntry = (uint32_t) entries.size();
+    table.entryCount = (uint32_t) configs.size();
+
+    int maxCode = -1;
+    for (auto &config: configs) {
+        MetaLayoutEntry entry = {};
+        entry.value = config.value;
+        entry.name = intern(config.name);
+        entry.version = intern(config.version);
+        entry.displayName = config.version.empty() ? entry.name : intern(config.name + "," + config.version);
+        entries.push_back(entry);
+        if (config.value <= MAX_DENSE_CODE) {
+            maxCode = max(maxCode, config.value);
+        }
+    }
+
+    // 编码重复时以第一次出现的为准
+    table.firstCodeIndex = (uint32_t) codeIndex.size();
+    table.codeIndexCount = (uint32_t) (maxCode + 1);
+    codeIndex.resize(codeIndex.size() + table.codeIndexCount, -1);
+    table.firstSparseCode = (uint32_t) sparseCodes.size();
+    for (size_t i = 0; i < configs.size(); i++) {
+        int code = configs[i].value;
+        if (code > MAX_DENSE_CODE) {
+            sparseCodes.push_back({code, (uint32_t) i});
+        } else if (code >= 0 && codeIndex[table.firstCodeIndex + code] < 0) {
+            codeIndex[table.firstCodeIndex + code] = (int32_t) i;
+        }
+    }
+    table.sparseCodeCount = (uint32_t) (sparseCodes.size() - table.firstSparseCode);
+    stable_sort(sparseCodes.begin() + table.firstSparseCode, sparseCodes.end(),
+                [](const MetaLayoutCode &lhs, const MetaLayoutCode &rhs) -> bool {
+                    return lhs.code < rhs.code;
+                });
+
+    // 先放不带版本号的名字, 与带版本号的名字重复时以前者为准
+    vector<pair<uint32_t, int>> names;
+    const MetaLayoutEntry *tableEntries = &entries[table.firstEntry];
+    for (uint32_t i = 0; i < table.entryCount; i++) {
+        names.emplace_back(tableEntries[i].name, tableEntries[i].value);
+    }
+    for (uint32_t i = 0; i < table.entryCount; i++) {
+        if (tableEntries[i].displayName != tableEntries[i].name) {
+            names.emplace_back(tableEntries[i].displayName, tableEntries[i].value);
+        }
+    }
+    vector<uint32_t> tableSeeds;
+    vector<MetaLayoutSlot> tableSlots;
+    MMSPerfectHash::build(stringPool.data(), names, tableSeeds, tableSlots);
+    table.firstSeed = (uint32_t) seeds.size();
+    table.seedCount = (uint32_t) tableSeeds.size();
+    seeds.insert(seeds.end(), tableSeeds.begin(), tableSeeds.end());
+    table.firstSlot = (uint32_t) slots.size();
+    table.slotCount = (uint32_t) tableSlots.size();
+    slots.insert(slots.end(), tableSlots.begin(), tableSlots.end());
+
+    tables.push_back(table);
+}
+
+MetaLayout MMSMetaDataBuilder::layout() const {
+    MetaLayout data = {};
+    data.tables = tables.data();
+    data.tableCount = (uint32_t) tables.size();
+    data.entries = entries.data();
+    data.codeIndex = codeIndex.data();
+    data.sparseCodes = sparseCodes.data();
+    data.seeds = seeds.data();
+    data.slots = slots.data();
+    data.stringPool = stringPool.data();
+    return data;
+}
@@ -0,0 +1,61 @@
+#ifndef FREEMMS_MMSMETADATABUILDER_H
+#define FREEMMS_MMSMETADATABUILDER_H
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "MMSMetaDataLayout.h"
+
+/**
+ * 生成 MMSMetaDataLayout.h 中的各数组
+ * mmsmetagen 用它生成内置表和快照, MMSMetaDataManager 用它加载 json 目录, 三者的布局和索引完全一致
+ */
+class MMSMetaDataBuilder {
+public:
+    // 直接索引覆盖的最大编码, 更大的编码(如私有的字符集 MIBenum)放入按编码排序的稀疏表
+    static const int MAX_DENSE_CODE = 0xFFFF;
+
+    // 元数据 json 文件名(不含扩展名), 也是各表的名字
+    static const char *const META_FILES[];
+    static const size_t META_FILE_COUNT;
+
+    struct Config {
+        std::string name;
+        std::string version;
+        int value;
+    };
+
+    std::vector<MetaLayoutTable> tables;
+    std::vector<MetaLayoutEntry> entries;
+    std::vector<int32_t> codeIndex;
+    std::vector<MetaLayoutCode> sparseCodes;
+    std::vector<uint32_t> seeds;
+    std::vector<MetaLayoutSlot> slots;
+    std::vector<char> stringPool;
+
+    /**
+     * 追加一张表, 计算带版本号的名字、按编码的索引和按名字反查的完美哈希
+     *
+     * @throw std::runtime_error 找不到完美哈希的种子
+     */
+    void addTable(const char *file, const std::vector<Config> &configs);
+
+    /**
+     * 读取 configDir/file.json 并追加为一张表
+     *
+     * @throw std::runtime_error 文件不存在或格式错误, 或者找不到完美哈希的种子
+     */
+    void addJsonFile(const std::string &configDir, const char *file);
+
+    /**
+     * 各数组的视图, 在本对象被修改或销毁前有效
+     */
+    MetaLayout layout() const;
+
+private:
+    std::unordered_map<std::string, uint32_t> stringOffsets;
+
+    uint32_t intern(const std::string &str);
+};
+
+#endif //FREEMMS_MMSMETADATABUILDER_H
@@ -0,0 +1,12 @@
+#ifndef FREEMMS_MMSMETADATABUILTIN_H
+#define FREEMMS_MMSMETADATABUILTIN_H
+
+#include "MMSMetaDataLayout.h"
+
+/**
+ * 构建时由 src/core/metadata 下的 json 文件生成的内置元数据, 见 src/tools/mmsmetagen.cpp
+ * 各数组为 constexpr, 位于 .rodata 中, MMSMetaDataManager 直接在其上查找
+ */
+extern const MetaLayout builtinMetaData;
+
+#endif //FREEMMS_MMSMETADATABUILTIN_H
@@ -0,0 +1,67 @@
+#ifndef FREEMMS_MMSMETADATALAYOUT_H
+#define FREEMMS_MMSMETADATALAYOUT_H
+
+#include <cstdint>
+
+/**
+ * 元数据在内存中的布局, 由 MMSMetaDataBuilder 生成
+ * 内置元数据由 mmsmetagen 生成为该布局的 constexpr 数组, 快照文件也以该布局保存(见 MMSMetaDataSnapshot.h),
+ * MMSMetaDataManager 直接在这些数组上查找, 不做任何转换
+ */
+
+struct MetaLayoutTable {
+    // 对应的 json 文件名, 不含扩展名
+    char file[48];
+    // 该表第一个条目在条目数组中的下标
+    uint32_t firstEntry;
+    uint32_t entryCount;
+    // 编码 -> 表内条目下标的直接索引, 在 codeIndex 数组中的位置
+    uint32_t firstCodeIndex;
+    uint32_t codeIndexCount;
+    // 超出直接索引范围的编码, 按编码排序
+    uint32_t firstSparseCode;
+    uint32_t sparseCodeCount;
+    // 名字 -> 编码的完美哈希, 见 MMSPerfectHash
+    uint32_t firstSeed;
+    uint32_t seedCount;
+    uint32_t firstSlot;
+    uint32_t slotCount;
+};
+
+struct MetaLayoutEntry {
+    int32_t value;
+    // 以下均为字符串池中的偏移
+    uint32_t name;
+    uint32_t version;
+    // 有版本号时为 "name,version", 否则与 name 相同
+    uint32_t displayName;
+};
+
+struct MetaLayoutCode {
+    int32_t code;
+    // 表内条目下标
+    uint32_t entry;
+};
+
+struct MetaLayoutSlot {
+    // 名字在字符串池中的偏移
+    uint32_t key;
+    // 编码, -1 表示空槽
+    int32_t value;
+};
+
+/**
+ * 一份元数据各数组的只读视图, 指向 .rodata、映射的快照文件或 MMSMetaDataBuilder 持有的内存
+ */
+struct MetaLayout {
+    const MetaLayoutTable *tables;
+    uint32_t tableCount;
+    const MetaLayoutEntry *entries;
+    const int32_t *codeIndex;
+    const MetaLayoutCode *sparseCodes;
+    const uint32_t *seeds;
+    const MetaLayoutSlot *slots;
+    const char *stringPool;
+};
+
+#endif //FREEMMS_MMSMETADATALAYOUT_H
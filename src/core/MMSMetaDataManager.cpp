@@ -1,174 +1,317 @@
 #include "MMSMetaDataManager.h"
 
-#include <fstream>
-#include <sstream>
 #include <algorithm>
+#include <climits>
+#include <cstring>
+#include <memory>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
-#include "json.hpp"
+#include "MMSMetaDataBuilder.h"
+#include "MMSMetaDataBuiltin.h"
+#include "MMSMetaDataSnapshot.h"
 
 using namespace std;
-using namespace nlohmann;
 
-static void parseConfigFile(const std::string &filePath, MMSMetaDataManager::MetaConfigList &configList) {
-    ifstream s(filePath);
-    if (!s.is_open()) {
-        throw runtime_error("file not exist");
+void MetaTable::attach(const MetaLayout &data, const MetaLayoutTable &table) {
+    this->entries = data.entries + table.firstEntry;
+    this->codeIndex = data.codeIndex + table.firstCodeIndex;
+    this->codeIndexCount = table.codeIndexCount;
+    this->sparseCodes = data.sparseCodes + table.firstSparseCode;
+    this->sparseCodeCount = table.sparseCodeCount;
+    this->stringPool = data.stringPool;
+    this->byName.attach(data.seeds + table.firstSeed, table.seedCount, data.slots + table.firstSlot, table.slotCount,
+                        data.stringPool);
+}
+
+const MetaLayoutEntry *MetaTable::findSparse(int code) const {
+    const MetaLayoutCode *end = this->sparseCodes + this->sparseCodeCount;
+    auto it = lower_bound(this->sparseCodes, end, code, [](const MetaLayoutCode &lhs, int rhs) -> bool {
+        return lhs.code < rhs;
+    });
+    if (it == end || it->code != code) {
+        return nullptr;
     }
+    return &this->entries[it->entry];
+}
 
-    json dataJson;
-    s >> dataJson;
-    for (auto &obj: dataJson) {
-        MetaConfig config;
-        if (obj.contains("VERSION")) {
-            config.version = obj.at("VERSION").get<string>();
+MMSName MetaTable::nameOf(int code) const {
+    const MetaLayoutEntry *entry = find(code);
+    return entry != nullptr ? MMSName(this->stringPool + entry->name) : MMSName();
+}
+
+MMSName MetaTable::displayNameOf(int code) const {
+    const MetaLayoutEntry *entry = find(code);
+    return entry != nullptr ? MMSName(this->stringPool + entry->displayName) : MMSName();
+}
+
+MetaTable *MMSMetaDataManager::tableOf(const std::string &file) {
+    if (file == "character_sets_mibenum") {
+        return &this->characterSetMIBENumConfig;
+    } else if (file == "mms_header_field") {
+        return &this->mmsHeaderFieldConfig;
+    } else if (file == "mms_option_content_type") {
+        return &this->mmsOptionContentTypeConfig;
+    } else if (file == "mms_option_delivery_report") {
+        return &this->mmsOptionDeliveryReportConfig;
+    } else if (file == "mms_option_message_class") {
+        return &this->mmsOptionMessageClassConfig;
+    } else if (file == "mms_option_message_type") {
+        return &this->mmsOptionMessageTypeConfig;
+    } else if (file == "mms_option_priority") {
+        return &this->mmsOptionPriorityConfig;
+    } else if (file == "mms_option_read_reply") {
+        return &this->mmsOptionReadReplyConfig;
+    } else if (file == "mms_option_report_allowed") {
+        return &this->mmsOptionReportAllowedConfig;
+    } else if (file == "mms_option_response_status") {
+        return &this->mmsOptionResponseStatusConfig;
+    } else if (file == "mms_param_field") {
+        return &this->mmsOptionParamFieldConfig;
+    } else if (file == "mms_param_wellknown") {
+        return &this->mmsOptionParamWellknownConfig;
+    }
+    return nullptr;
+}
+
+void MMSMetaDataManager::attach(const MetaLayout &data) {
+    for (uint32_t i = 0; i < data.tableCount; i++) {
+        const MetaLayoutTable &table = data.tables[i];
+        MetaTable *metaTable = tableOf(string(table.file, strnlen(table.file, sizeof(table.file))));
+        if (metaTable != nullptr) {
+            metaTable->attach(data, table);
         }
-        config.name = obj.at("NAME").get<string>();
-        config.value = obj.at("VALUE").get<int>();
-        configList.push_back(config);
     }
 }
 
-MMSMetaDataManager::MMSMetaDataManager(const std::string &configDir) : configDir(configDir) {
-    parseConfigFile(configDir + "/character_sets_mibenum.json", this->characterSetMIBENumConfig);
-    parseConfigFile(configDir + "/mms_header_field.json", this->mmsHeaderFieldConfig);
-    parseConfigFile(configDir + "/mms_option_content_type.json", this->mmsOptionContentTypeConfig);
-    parseConfigFile(configDir + "/mms_option_delivery_report.json", this->mmsOptionDeliveryReportConfig);
-    parseConfigFile(configDir + "/mms_option_message_class.json", this->mmsOptionMessageClassConfig);
-    parseConfigFile(configDir + "/mms_option_message_type.json", this->mmsOptionMessageTypeConfig);
-    parseConfigFile(configDir + "/mms_option_priority.json", this->mmsOptionPriorityConfig);
-    parseConfigFile(configDir + "/mms_option_read_reply.json", this->mmsOptionReadReplyConfig);
-    parseConfigFile(configDir + "/mms_option_report_allowed.json", this->mmsOptionReportAllowedConfig);
-    parseConfigFile(configDir + "/mms_option_response_status.json", this->mmsOptionResponseStatusConfig);
-    parseConfigFile(configDir + "/mms_param_field.json", this->mmsOptionParamFieldConfig);
-    parseConfigFile(configDir + "/mms_param_wellknown.json", this->mmsOptionParamWellknownConfig);
-}
-
-std::string MMSMetaDataManager::findFieldNameByCode(unsigned char fieldCode) {
-    int markCode = fieldCode & 0x7F;
-
-    auto it = find_if(this->mmsHeaderFieldConfig.begin(), this->mmsHeaderFieldConfig.end(),
-                      [markCode](const MetaConfig &rhs) -> bool {
-                          return rhs.value == markCode;
-                      });
-    if (it != mmsHeaderFieldConfig.end()) {
-        return it->name;
-    } else {
-        return "";
-    }
-}
-
-std::string MMSMetaDataManager::findMessageTypeNameByCode(unsigned char messageTypeCode) {
-    auto it = find_if(this->mmsOptionMessageTypeConfig.begin(), this->mmsOptionMessageTypeConfig.end(),
-                      [messageTypeCode](const MetaConfig &rhs) -> bool {
-                          return rhs.value == messageTypeCode;
-                      });
-    if (it != mmsOptionMessageTypeConfig.end()) {
-        return it->name;
-    } else {
-        return "";
-    }
-}
-
-std::string MMSMetaDataManager::findMessageClassByCode(unsigned char messageClassCode) {
-    auto it = find_if(this->mmsOptionMessageClassConfig.begin(), this->mmsOptionMessageClassConfig.end(),
-                      [messageClassCode](const MetaConfig &rhs) -> bool {
-                          return rhs.value == messageClassCode;
-                      });
-    if (it != mmsOptionMessageClassConfig.end()) {
-        return it->name;
-    } else {
-        return "";
-    }
-}
-
-std::string MMSMetaDataManager::findPriorityByCode(unsigned char priorityCode) {
-    auto it = find_if(this->mmsOptionPriorityConfig.begin(), this->mmsOptionPriorityConfig.end(),
-                      [priorityCode](const MetaConfig &rhs) -> bool {
-                          return rhs.value == priorityCode;
-                      });
-    if (it != mmsOptionPriorityConfig.end()) {
-        return it->name;
-    } else {
-        return "";
-    }
-}
-
-std::string MMSMetaDataManager::findDeliveryReportByCode(unsigned char deliveryReportCode) {
-    auto it = find_if(this->mmsOptionDeliveryReportConfig.begin(), this->mmsOptionDeliveryReportConfig.end(),
-                      [deliveryReportCode](const MetaConfig &rhs) -> bool {
-                          return rhs.value == deliveryReportCode;
-                      });
-    if (it != mmsOptionDeliveryReportConfig.end()) {
-        return it->name;
-    } else {
-        return "";
-    }
-}
-
-std::string MMSMetaDataManager::findReadReplyByCode(unsigned char readReplyCode) {
-    auto it = find_if(this->mmsOptionReadReplyConfig.begin(), this->mmsOptionReadReplyConfig.end(),
-                      [readReplyCode](const MetaConfig &rhs) -> bool {
-                          return rhs.value == readReplyCode;
-                      });
-    if (it != mmsOptionReadReplyConfig.end()) {
-        return it->name;
-    } else {
-        return "";
-    }
-}
-
-std::string MMSMetaDataManager::findCharacterSetByCode(unsigned char mibeNum) {
-    auto it = find_if(this->characterSetMIBENumConfig.begin(), this->characterSetMIBENumConfig.end(),
-                      [mibeNum](const MetaConfig &rhs) -> bool {
-                          return rhs.value == mibeNum;
-                      });
-    if (it != characterSetMIBENumConfig.end()) {
-        return it->name;
-    } else {
-        return "";
-    }
-}
-
-std::string MMSMetaDataManager::findContentTypeByCode(unsigned char contentTypeCode) {
-    auto it = find_if(this->mmsOptionContentTypeConfig.begin(), this->mmsOptionContentTypeConfig.end(),
-                      [contentTypeCode](const MetaConfig &rhs) -> bool {
-                          return rhs.value == contentTypeCode;
-                      });
-    if (it != mmsOptionContentTypeConfig.end()) {
-        return it->name;
-    } else {
-        return "";
-    }
-}
+/**
+ * 计算快照中下一段数组的位置, 超出文件大小时返回 false
+ */
+static bool snapshotSection(size_t size, size_t &offset, uint32_t count, size_t itemSize, size_t &sectionOffset) {
+    if (offset > size || count > (size - offset) / itemSize) {
+        return false;
+    }
+    sectionOffset = offset;
+    offset += count * itemSize;
+    return true;
+}
+
+void MMSMetaDataManager::loadSnapshot(const std::string &snapshotPath) {
+    int fd = open(snapshotPath.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw runtime_error("file not exist " + snapshotPath);
+    }
+
+    struct stat st = {};
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        throw runtime_error("can not stat snapshot " + snapshotPath);
+    }
+    auto size = (size_t) st.st_size;
+    void *addr = size > 0 ? mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+    close(fd);
+    if (addr == MAP_FAILED) {
+        throw runtime_error("can not map snapshot " + snapshotPath);
+    }
+    // 映射在管理器(及其副本)的整个生命周期内保持有效, 查找结果直接指向映射的内存
+    std::shared_ptr<const void> mapping(addr, [size](const void *p) {
+        munmap(const_cast<void *>(p), size);
+    });
+
+    const char *base = static_cast<const char *>(addr);
+    auto header = reinterpret_cast<const MetaSnapshotHeader *>(base);
+    if (size < sizeof(MetaSnapshotHeader)
+        || memcmp(header->magic, META_SNAPSHOT_MAGIC, sizeof(header->magic)) != 0
+        || header->version != META_SNAPSHOT_VERSION) {
+        throw runtime_error("invalid snapshot " + snapshotPath);
+    }
+
+    size_t offset = sizeof(MetaSnapshotHeader);
+    size_t tableOffset = 0;
+    size_t entryOffset = 0;
+    size_t codeIndexOffset = 0;
+    size_t sparseCodeOffset = 0;
+    size_t seedOffset = 0;
+    size_t slotOffset = 0;
+    size_t poolOffset = 0;
+    if (!snapshotSection(size, offset, header->tableCount, sizeof(MetaLayoutTable), tableOffset)
+        || !snapshotSection(size, offset, header->entryCount, sizeof(MetaLayoutEntry), entryOffset)
+        || !snapshotSection(size, offset, header->codeIndexCount, sizeof(int32_t), codeIndexOffset)
+        || !snapshotSection(size, offset, header->sparseCodeCount, sizeof(MetaLayoutCode), sparseCodeOffset)
+        || !snapshotSection(size, offset, header->seedCount, sizeof(uint32_t), seedOffset)
+        || !snapshotSection(size, offset, header->slotCount, sizeof(MetaLayoutSlot), slotOffset)
+        || !snapshotSection(size, offset, header->stringPoolSize, sizeof(char), poolOffset)
+        || header->stringPoolSize == 0 || base[poolOffset + header->stringPoolSize - 1] != '\0') {
+        throw runtime_error("invalid snapshot " + snapshotPath);
+    }
 
-std::string MMSMetaDataManager::findParamWellknownByCode(unsigned char paramWellknownCode) {
-    auto it = find_if(this->mmsOptionParamWellknownConfig.begin(), this->mmsOptionParamWellknownConfig.end(),
-                      [paramWellknownCode](const MetaConfig &rhs) -> bool {
-                          return rhs.value == paramWellknownCode;
-                      });
-    if (it != mmsOptionParamWellknownConfig.end()) {
-        if (it->version.length() == 0) {
-            return it->name;
-        } else {
-            return it->name + "," + it->version;
+    MetaLayout data = {};
+    data.tables = reinterpret_cast<const MetaLayoutTable *>(base + tableOffset);
+    data.tableCount = header->tableCount;
+    data.entries = reinterpret_cast<const MetaLayoutEntry *>(base + entryOffset);
+    data.codeIndex = reinterpret_cast<const int32_t *>(base + codeIndexOffset);
+    data.sparseCodes = reinterpret_cast<const MetaLayoutCode *>(base + sparseCodeOffset);
+    data.seeds = reinterpret_cast<const uint32_t *>(base + seedOffset);
+    data.slots = reinterpret_cast<const MetaLayoutSlot *>(base + slotOffset);
+    data.stringPool = base + poolOffset;
+
+    // 字符串池以 0 结尾, 偏移在池内即保证字符串以 0 结尾
+    for (uint32_t i = 0; i < header->entryCount; i++) {
+        const MetaLayoutEntry &entry = data.entries[i];
+        if (entry.name >= header->stringPoolSize || entry.version >= header->stringPoolSize
+            || entry.displayName >= header->stringPoolSize) {
+            throw runtime_error("invalid snapshot " + snapshotPath);
+        }
+    }
+    for (uint32_t i = 0; i < header->slotCount; i++) {
+        if (data.slots[i].value >= 0 && data.slots[i].key >= header->stringPoolSize) {
+            throw runtime_error("invalid snapshot " + snapshotPath);
         }
-    } else {
-        return "";
     }
+    for (uint32_t i = 0; i < header->tableCount; i++) {
+        const MetaLayoutTable &table = data.tables[i];
+        if ((size_t) table.firstEntry + table.entryCount > header->entryCount
+            || (size_t) table.firstCodeIndex + table.codeIndexCount > header->codeIndexCount
+            || (size_t) table.firstSparseCode + table.sparseCodeCount > header->sparseCodeCount
+            || (size_t) table.firstSeed + table.seedCount > header->seedCount
+            || (size_t) table.firstSlot + table.slotCount > header->slotCount) {
+            throw runtime_error("invalid snapshot " + snapshotPath);
+        }
+        for (uint32_t j = 0; j < table.codeIndexCount; j++) {
+            int32_t entry = data.codeIndex[table.firstCodeIndex + j];
+            if (entry >= 0 && (uint32_t) entry >= table.entryCount) {
+                throw runtime_error("invalid snapshot " + snapshotPath);
+            }
+        }
+        for (uint32_t j = 0; j < table.sparseCodeCount; j++) {
+            if (data.sparseCodes[table.firstSparseCode + j].entry >= table.entryCount) {
+                throw runtime_error("invalid snapshot " + snapshotPath);
+            }
+        }
+    }
+
+    this->storage = std::move(mapping);
+    attach(data);
 }
 
-std::string MMSMetaDataManager::findParamFieldByCode(unsigned char paramFieldCode) {
-    auto it = find_if(this->mmsOptionParamFieldConfig.begin(), this->mmsOptionParamFieldConfig.end(),
-                      [paramFieldCode](const MetaConfig &rhs) -> bool {
-                          return rhs.value == paramFieldCode;
-                      });
-    if (it != mmsOptionParamFieldConfig.end()) {
-        if (it->version.length() == 0) {
-            return it->name;
-        } else {
-            return it->name + "," + it->version;
-        }
-    } else {
-        return "";
+MMSMetaDataManager::MMSMetaDataManager() {
+    attach(builtinMetaData);
+}
+
+MMSMetaDataManager::MMSMetaDataManager(const std::string &configDir) : configDir(configDir) {
+    struct stat st = {};
+    if (stat(configDir.c_str(), &st) == 0 && S_ISREG(st.st_mode)) {
+        loadSnapshot(configDir);
+        return;
+    }
+
+    string snapshotPath = configDir + "/" + META_SNAPSHOT_FILE;
+    if (stat(snapshotPath.c_str(), &st) == 0 && S_ISREG(st.st_mode)) {
+        loadSnapshot(snapshotPath);
+        return;
+    }
+
+    auto builder = make_shared<MMSMetaDataBuilder>();
+    for (size_t i = 0; i < MMSMetaDataBuilder::META_FILE_COUNT; i++) {
+        builder->addJsonFile(configDir, MMSMetaDataBuilder::META_FILES[i]);
     }
+    this->storage = builder;
+    attach(builder->layout());
+}
+
+MMSName MMSMetaDataManager::findFieldNameByCode(unsigned char fieldCode) const {
+    return mmsHeaderFieldConfig.nameOf(fieldCode & 0x7F);
+}
+
+int MMSMetaDataManager::findFieldCodeByName(const std::string &fieldName) const {
+    return mmsHeaderFieldConfig.codeOf(fieldName);
+}
+
+int MMSMetaDataManager::findMessageTypeCodeByName(const std::string &messageTypeName) const {
+    return mmsOptionMessageTypeConfig.codeOf(messageTypeName);
+}
+
+int MMSMetaDataManager::findMessageClassCodeByName(const std::string &messageClassName) const {
+    return mmsOptionMessageClassConfig.codeOf(messageClassName);
+}
+
+int MMSMetaDataManager::findPriorityCodeByName(const std::string &priorityName) const {
+    return mmsOptionPriorityConfig.codeOf(priorityName);
+}
+
+int MMSMetaDataManager::findDeliveryReportCodeByName(const std::string &deliveryReportName) const {
+    return mmsOptionDeliveryReportConfig.codeOf(deliveryReportName);
+}
+
+int MMSMetaDataManager::findReadReplyCodeByName(const std::string &readReplyName) const {
+    return mmsOptionReadReplyConfig.codeOf(readReplyName);
+}
+
+int MMSMetaDataManager::findReportAllowedCodeByName(const std::string &reportAllowedName) const {
+    return mmsOptionReportAllowedConfig.codeOf(reportAllowedName);
+}
+
+int MMSMetaDataManager::findResponseStatusCodeByName(const std::string &responseStatusName) const {
+    return mmsOptionResponseStatusConfig.codeOf(responseStatusName);
+}
+
+int MMSMetaDataManager::findCharacterSetCodeByName(const std::string &charsetName) const {
+    return characterSetMIBENumConfig.codeOf(charsetName);
+}
+
+int MMSMetaDataManager::findContentTypeCodeByName(const std::string &contentTypeName) const {
+    return mmsOptionContentTypeConfig.codeOf(contentTypeName);
+}
+
+int MMSMetaDataManager::findParamWellknownCodeByName(const std::string &paramWellknownName) const {
+    return mmsOptionParamWellknownConfig.codeOf(paramWellknownName);
+}
+
+int MMSMetaDataManager::findParamFieldCodeByName(const std::string &paramFieldName) const {
+    return mmsOptionParamFieldConfig.codeOf(paramFieldName);
+}
+
+MMSName MMSMetaDataManager::findMessageTypeNameByCode(unsigned char messageTypeCode) const {
+    return mmsOptionMessageTypeConfig.nameOf(messageTypeCode);
+}
+
+MMSName MMSMetaDataManager::findMessageClassByCode(unsigned char messageClassCode) const {
+    return mmsOptionMessageClassConfig.nameOf(messageClassCode);
+}
+
+MMSName MMSMetaDataManager::findPriorityByCode(unsigned char priorityCode) const {
+    return mmsOptionPriorityConfig.nameOf(priorityCode);
+}
+
+MMSName MMSMetaDataManager::findDeliveryReportByCode(unsigned char deliveryReportCode) const {
+    return mmsOptionDeliveryReportConfig.nameOf(deliveryReportCode);
+}
+
+MMSName MMSMetaDataManager::findReadReplyByCode(unsigned char readReplyCode) const {
+    return mmsOptionReadReplyConfig.nameOf(readReplyCode);
+}
+
+MMSName MMSMetaDataManager::findCharacterSetByCode(long mibeNum) const {
+    if (mibeNum < 0 || mibeNum > INT_MAX) {
+        return {};
+    }
+    return characterSetMIBENumConfig.nameOf((int) mibeNum);
+}
+
+MMSName MMSMetaDataManager::findContentTypeByCode(unsigned char contentTypeCode) const {
+    return mmsOptionContentTypeConfig.nameOf(contentTypeCode);
+}
+
+MMSName MMSMetaDataManager::findParamWellknownByCode(unsigned char paramWellknownCode) const {
+    return mmsOptionParamWellknownConfig.displayNameOf(paramWellknownCode);
+}
+
+MMSName MMSMetaDataManager::findParamFieldByCode(unsigned char paramFieldCode) const {
+    return mmsOptionParamFieldConfig.displayNameOf(paramFieldCode);
+}
+
+MMSName MMSMetaDataManager::findParamWellknownNameByCode(unsigned char paramWellknownCode) const {
+    return mmsOptionParamWellknownConfig.nameOf(paramWellknownCode & 0x7F);
 }
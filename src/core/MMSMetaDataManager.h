@@ -1,54 +1,172 @@
 #ifndef FREEMMS_MMSMETADATAMANAGER_H
 #define FREEMMS_MMSMETADATAMANAGER_H
 
+#include <memory>
 #include <string>
-#include <vector>
+#include "MMSName.h"
+#include "MMSPerfectHash.h"
+#include "MMSMetaDataLayout.h"
 
-struct MetaConfig {
-    std::string name;
-    std::string version;
-    int value;
+/**
+ * 一张元数据表在 MetaLayout 上的视图, 不复制条目和字符串, 查找直接访问原数组
+ * 编码不超过 MMSMetaDataBuilder::MAX_DENSE_CODE 时通过直接索引一次数组下标访问找到条目,
+ * 更大的编码(如私有的字符集 MIBenum)在按编码排序的稀疏表中二分查找
+ */
+class MetaTable {
+private:
+    const MetaLayoutEntry *entries = nullptr;
+    const int32_t *codeIndex = nullptr;
+    uint32_t codeIndexCount = 0;
+    const MetaLayoutCode *sparseCodes = nullptr;
+    uint32_t sparseCodeCount = 0;
+    const char *stringPool = nullptr;
+    // 名字(及带版本号的名字) -> 编码, 指向 data 中预先计算的种子和槽位
+    MMSPerfectHash byName;
+
+    const MetaLayoutEntry *findSparse(int code) const;
+public:
+    /**
+     * 指向 data 中的 table, data 需要在本对象的使用期间保持有效
+     */
+    void attach(const MetaLayout &data, const MetaLayoutTable &table);
+
+    const MetaLayoutEntry *find(int code) const {
+        if (code < 0) {
+            return nullptr;
+        }
+        if ((uint32_t) code >= codeIndexCount) {
+            return findSparse(code);
+        }
+        return codeIndex[code] < 0 ? nullptr : &entries[codeIndex[code]];
+    }
+
+    /**
+     * @return 编码对应的名字, 找不到时返回空字符串
+     */
+    MMSName nameOf(int code) const;
+
+    /**
+     * @return 编码对应的带版本号的名字, 找不到时返回空字符串
+     */
+    MMSName displayNameOf(int code) const;
+
+    /**
+     * 按名字或 "name,version" 反查编码, 不区分大小写
+     * @return 编码, 找不到时返回 -1
+     */
+    int codeOf(const std::string &name) const {
+        return byName.find(name);
+    }
 };
 
+/**
+ * 查找结果以 MMSName 返回, 直接指向元数据的字符串池, 解析过程中不分配内存
+ * 内置元数据指向编译进库的数组; json 和快照的数据由 storage 持有, 复制的管理器共享同一份数据
+ */
 class MMSMetaDataManager {
-public:
-    typedef std::vector<MetaConfig> MetaConfigList;
 private:
     std::string configDir;
-    MetaConfigList characterSetMIBENumConfig;
-    MetaConfigList mmsHeaderFieldConfig;
-    MetaConfigList mmsOptionContentTypeConfig;
-    MetaConfigList mmsOptionDeliveryReportConfig;
-    MetaConfigList mmsOptionMessageClassConfig;
-    MetaConfigList mmsOptionMessageTypeConfig;
-    MetaConfigList mmsOptionPriorityConfig;
-    MetaConfigList mmsOptionReadReplyConfig;
-    MetaConfigList mmsOptionReportAllowedConfig;
-    MetaConfigList mmsOptionResponseStatusConfig;
-    MetaConfigList mmsOptionParamFieldConfig;
-    MetaConfigList mmsOptionParamWellknownConfig;
+    // json 加载时为 MMSMetaDataBuilder, 快照加载时为文件映射, 内置元数据时为空
+    std::shared_ptr<const void> storage;
+    MetaTable characterSetMIBENumConfig;
+    MetaTable mmsHeaderFieldConfig;
+    MetaTable mmsOptionContentTypeConfig;
+    MetaTable mmsOptionDeliveryReportConfig;
+    MetaTable mmsOptionMessageClassConfig;
+    MetaTable mmsOptionMessageTypeConfig;
+    MetaTable mmsOptionPriorityConfig;
+    MetaTable mmsOptionReadReplyConfig;
+    MetaTable mmsOptionReportAllowedConfig;
+    MetaTable mmsOptionResponseStatusConfig;
+    MetaTable mmsOptionParamFieldConfig;
+    MetaTable mmsOptionParamWellknownConfig;
+
+    /**
+     * @return 元数据文件名(不含扩展名)对应的配置表, 未知文件名返回 nullptr
+     */
+    MetaTable *tableOf(const std::string &file);
+
+    void attach(const MetaLayout &data);
+
+    /**
+     * 通过 mmap 加载 mmsmetagen --snapshot 生成的二进制快照, 校验后直接在映射上查找, 不复制也不做文本解析
+     *
+     * @throw std::runtime_error 文件无法读取或映射, 或者快照的版本、大小、偏移不合法
+     */
+    void loadSnapshot(const std::string &snapshotPath);
+
 public:
+    /**
+     * 使用构建时编译进库的内置元数据, 不依赖文件系统
+     */
+    MMSMetaDataManager();
+
+    /**
+     * 从 configDir 加载元数据, 用于覆盖内置元数据
+     * configDir 为文件或目录下存在 metadata.snapshot 时按二进制快照加载, 否则加载目录下的 json 文件
+     */
     explicit MMSMetaDataManager(const std::string &configDir);
 
-    std::string findFieldNameByCode(unsigned char fieldCode);
+    MMSName findFieldNameByCode(unsigned char fieldCode) const;
+
+    /**
+     * @return 字段编码(不含最高位), 找不到时返回 -1
+     */
+    int findFieldCodeByName(const std::string &fieldName) const;
+
+    /**
+     * 以下为编码时使用的反向查找, 名字不区分大小写, 找不到时返回 -1
+     */
+    int findMessageTypeCodeByName(const std::string &messageTypeName) const;
+
+    int findMessageClassCodeByName(const std::string &messageClassName) const;
+
+    int findPriorityCodeByName(const std::string &priorityName) const;
+
+    int findDeliveryReportCodeByName(const std::string &deliveryReportName) const;
+
+    int findReadReplyCodeByName(const std::string &readReplyName) const;
+
+    int findReportAllowedCodeByName(const std::string &reportAllowedName) const;
+
+    int findResponseStatusCodeByName(const std::string &responseStatusName) const;
+
+    /**
+     * @return 字符集的 IANA MIBenum, 找不到时返回 -1
+     */
+    int findCharacterSetCodeByName(const std::string &charsetName) const;
+
+    int findContentTypeCodeByName(const std::string &contentTypeName) const;
+
+    int findParamWellknownCodeByName(const std::string &paramWellknownName) const;
+
+    int findParamFieldCodeByName(const std::string &paramFieldName) const;
+
+    MMSName findMessageTypeNameByCode(unsigned char messageTypeCode) const;
 
-    std::string findMessageTypeNameByCode(unsigned char messageTypeCode);
+    MMSName findMessageClassByCode(unsigned char messageClassCode) const;
 
-    std::string findMessageClassByCode(unsigned char messageClassCode);
+    MMSName findPriorityByCode(unsigned char priorityCode) const;
 
-    std::string findPriorityByCode(unsigned char priorityCode);
+    MMSName findDeliveryReportByCode(unsigned char deliveryReportCode) const;
 
-    std::string findDeliveryReportByCode(unsigned char deliveryReportCode);
+    MMSName findReadReplyByCode(unsigned char readReplyCode) const;
 
-    std::string findReadReplyByCode(unsigned char readReplyCode);
+    /**
+     * 按完整的 IANA MIBenum 查找字符集, 如 1000(ISO-10646-UCS-2), 2026(Big5)
+     */
+    MMSName findCharacterSetByCode(long mibeNum) const;
 
-    std::string findCharacterSetByCode(unsigned char mibeNum);
+    MMSName findContentTypeByCode(unsigned char contentTypeCode) const;
 
-    std::string findContentTypeByCode(unsigned char contentTypeCode);
+    MMSName findParamWellknownByCode(unsigned char paramWellknownCode) const;
 
-    std::string findParamWellknownByCode(unsigned char paramWellknownCode);
+    MMSName findParamFieldByCode(unsigned char paramFieldCode) const;
 
-    std::string findParamFieldByCode(unsigned char paramFieldCode);
+    /**
+     * @return 不含版本号的参数名, 找不到时返回空字符串
+     */
+    MMSName findParamWellknownNameByCode(unsigned char paramWellknownCode) const;
 };
 
 
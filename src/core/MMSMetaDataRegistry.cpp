@@ -0,0 +1,198 @@
+#include "MMSMetaDataRegistry.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <iterator>
+#include <map>
+#include <stdexcept>
+#include <thread>
+#include "spdlog/spdlog.h"
+
+using namespace std;
+
+static atomic<unsigned long> nextSlotId(1);
+
+MMSMetaDataSlot::MMSMetaDataSlot(std::shared_ptr<const MMSMetaDataManager> metaDataManager)
+        : id(nextSlotId++), generation(0), current(std::move(metaDataManager)) {
+}
+
+/**
+ * 线程最近一次取得的快照, 只持有弱引用, 不会延长旧版本的生命周期
+ */
+struct CachedSnapshot {
+    unsigned long slotId = 0;
+    unsigned long generation = 0;
+    weak_ptr<const MMSMetaDataManager> metaData;
+};
+
+// 每个线程按槽位编号缓存的快照数, 槽位编号连续分配, 同时使用的槽位不超过该数量时互不冲突
+static const size_t CACHED_SNAPSHOT_COUNT = 8;
+
+std::shared_ptr<const MMSMetaDataManager> MMSMetaDataSlot::snapshot() const {
+    static thread_local CachedSnapshot cachedSnapshots[CACHED_SNAPSHOT_COUNT];
+    CachedSnapshot &cached = cachedSnapshots[id % CACHED_SNAPSHOT_COUNT];
+    unsigned long g = generation.load(memory_order_acquire);
+    if (cached.slotId == id && cached.generation == g) {
+        shared_ptr<const MMSMetaDataManager> metaData = cached.metaData.lock();
+        if (metaData) {
+            return metaData;
+        }
+    }
+
+    // 先读版本号再取快照, 并发发布时快照可能比记录的版本号新, 下次调用会重新读取
+    shared_ptr<const MMSMetaDataManager> metaData = atomic_load(&current);
+    cached.slotId = id;
+    cached.generation = g;
+    cached.metaData = metaData;
+    return metaData;
+}
+
+void MMSMetaDataSlot::publish(std::shared_ptr<const MMSMetaDataManager> metaDataManager) {
+    atomic_store(&current, std::move(metaDataManager));
+    generation.fetch_add(1, memory_order_release);
+}
+
+/**
+ * 按 realpath 归一化后的路径缓存槽位, 以及调用方传入的原样路径到槽位的别名
+ * 命中别名时不需要访问文件系统
+ */
+struct MetaDataCache {
+    map<string, shared_ptr<MMSMetaDataSlot>> slots;
+    map<string, shared_ptr<MMSMetaDataSlot>> aliases;
+};
+
+static MetaDataCache &metaDataCache() {
+    static auto *cache = new MetaDataCache();
+    return *cache;
+}
+
+static mutex &metaDataCacheMutex() {
+    static auto *m = new mutex();
+    return *m;
+}
+
+/**
+ * 转换为绝对路径作为缓存键, metadata, metadata/ 和 ./metadata 对应同一个槽位
+ *
+ * @return configDir 不存在时返回 false
+ */
+static bool resolveConfigDir(const string &configDir, string &path) {
+    if (configDir.empty()) {
+        path.clear();
+        return true;
+    }
+
+    char *resolved = realpath(configDir.c_str(), nullptr);
+    if (resolved == nullptr) {
+        return false;
+    }
+    path = resolved;
+    free(resolved);
+    return true;
+}
+
+static string normalizeConfigDir(const string &configDir) {
+    string path;
+    if (!resolveConfigDir(configDir, path)) {
+        spdlog::error("config dir {} not exist", configDir);
+        throw runtime_error("config dir " + configDir + " not exist");
+    }
+    return path;
+}
+
+static shared_ptr<const MMSMetaDataManager> loadMetaData(const string &configDir) {
+    if (configDir.empty()) {
+        return make_shared<const MMSMetaDataManager>();
+    }
+    return make_shared<const MMSMetaDataManager>(configDir);
+}
+
+/**
+ * 查找已加载的槽位, 调用方需持有 metaDataCacheMutex
+ */
+static shared_ptr<MMSMetaDataSlot> findSlot(const map<string, shared_ptr<MMSMetaDataSlot>> &slots,
+                                            const string &key) {
+    auto it = slots.find(key);
+    return it != slots.end() ? it->second : nullptr;
+}
+
+std::shared_ptr<MMSMetaDataSlot> MMSMetaDataRegistry::slot(const std::string &configDir) {
+    auto &cache = metaDataCache();
+    {
+        lock_guard<mutex> lock(metaDataCacheMutex());
+        shared_ptr<MMSMetaDataSlot> metaDataSlot = findSlot(cache.aliases, configDir);
+        if (metaDataSlot) {
+            return metaDataSlot;
+        }
+    }
+
+    string key = normalizeConfigDir(configDir);
+    {
+        lock_guard<mutex> lock(metaDataCacheMutex());
+        shared_ptr<MMSMetaDataSlot> metaDataSlot = findSlot(cache.slots, key);
+        if (metaDataSlot) {
+            cache.aliases[configDir] = metaDataSlot;
+            return metaDataSlot;
+        }
+    }
+
+    // 加载时不持有全局锁, 不阻塞其他目录的引擎创建; 同一目录被并发首次加载时以先放入缓存的为准
+    auto loaded = make_shared<MMSMetaDataSlot>(loadMetaData(key));
+    lock_guard<mutex> lock(metaDataCacheMutex());
+    shared_ptr<MMSMetaDataSlot> metaDataSlot = cache.slots.emplace(key, loaded).first->second;
+    cache.aliases[configDir] = metaDataSlot;
+    return metaDataSlot;
+}
+
+std::shared_ptr<const MMSMetaDataManager> MMSMetaDataRegistry::get(const std::string &configDir) {
+    return slot(configDir)->snapshot();
+}
+
+void MMSMetaDataRegistry::evict(const std::string &configDir) {
+    auto &cache = metaDataCache();
+    string key;
+    bool resolved = resolveConfigDir(configDir, key);
+    lock_guard<mutex> lock(metaDataCacheMutex());
+    shared_ptr<MMSMetaDataSlot> metaDataSlot = findSlot(cache.aliases, configDir);
+    if (!metaDataSlot && resolved) {
+        metaDataSlot = findSlot(cache.slots, key);
+    }
+    if (!metaDataSlot) {
+        return;
+    }
+
+    for (auto e = cache.slots.begin(); e != cache.slots.end();) {
+        e = e->second == metaDataSlot ? cache.slots.erase(e) : next(e);
+    }
+    for (auto e = cache.aliases.begin(); e != cache.aliases.end();) {
+        e = e->second == metaDataSlot ? cache.aliases.erase(e) : next(e);
+    }
+    spdlog::info("metadata {} evicted", configDir);
+}
+
+std::future<void> MMSMetaDataRegistry::reload(const std::string &configDir) {
+    // 不使用 std::async: 它返回的 future 析构时会等待加载完成, 丢弃返回值的调用方会被阻塞
+    auto done = make_shared<promise<void>>();
+    future<void> result = done->get_future();
+    thread([configDir, done]() {
+        try {
+            string key = normalizeConfigDir(configDir);
+            shared_ptr<MMSMetaDataSlot> metaDataSlot;
+            {
+                lock_guard<mutex> lock(metaDataCacheMutex());
+                metaDataSlot = findSlot(metaDataCache().slots, key);
+            }
+            if (!metaDataSlot) {
+                spdlog::info("metadata {} is not loaded, skip reload", configDir);
+            } else {
+                lock_guard<mutex> lock(metaDataSlot->reloadMutex);
+                metaDataSlot->publish(loadMetaData(key));
+                spdlog::info("metadata {} reloaded", configDir);
+            }
+            done->set_value();
+        } catch (...) {
+            done->set_exception(current_exception());
+        }
+    }).detach();
+    return result;
+}
@@ -0,0 +1,77 @@
+#ifndef FREEMMS_MMSMETADATAREGISTRY_H
+#define FREEMMS_MMSMETADATAREGISTRY_H
+
+#include <atomic>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include "MMSMetaDataManager.h"
+
+/**
+ * 一个配置目录当前生效的元数据版本
+ * 读取方通过 snapshot() 取得当前版本并在整个解析过程中使用, 查找时不加锁;
+ * 重新加载时构建完整的新版本后原子地替换, 旧版本在最后一个持有者释放后销毁
+ */
+class MMSMetaDataSlot {
+private:
+    // 进程内唯一的槽位编号, 用于识别线程缓存的快照属于哪个槽位
+    const unsigned long id;
+    // 每次发布新版本后递增
+    std::atomic<unsigned long> generation;
+    std::shared_ptr<const MMSMetaDataManager> current;
+    // 串行化同一目录的重新加载, 读取方不使用
+    std::mutex reloadMutex;
+
+    friend class MMSMetaDataRegistry;
+
+public:
+    explicit MMSMetaDataSlot(std::shared_ptr<const MMSMetaDataManager> metaDataManager);
+
+    /**
+     * 当前版本. 每个线程按槽位缓存最近一次取得的版本号和该版本的弱引用,
+     * 版本未变化时只读取一次原子版本号并提升弱引用, 不进入 std::atomic_load 的互斥锁;
+     * 只有版本变化后的第一次调用才回退到 std::atomic_load, 线程交替使用多个槽位时各自命中缓存
+     */
+    std::shared_ptr<const MMSMetaDataManager> snapshot() const;
+
+    void publish(std::shared_ptr<const MMSMetaDataManager> metaDataManager);
+};
+
+/**
+ * 进程级的元数据注册表, 按配置目录缓存只读的 MMSMetaDataManager
+ * 同一配置目录在进程内只加载一次, 所有 MMSEngine 共享同一个实例; 实例加载后不再修改, 可被多个线程同时读取
+ */
+class MMSMetaDataRegistry {
+public:
+    /**
+     * 获取 configDir 对应的元数据槽位, 首次获取时加载, 之后直接返回缓存的槽位
+     * configDir 为空时为内置元数据, 否则按 realpath 归一化后的路径共享槽位.
+     * 先按 configDir 原样查找缓存, 命中时不访问文件系统; 相对路径在首次获取时按当前工作目录解析
+     * 槽位由注册表一直持有, 直到 evict
+     *
+     * @throw std::runtime_error configDir 不存在或加载失败
+     */
+    static std::shared_ptr<MMSMetaDataSlot> slot(const std::string &configDir);
+
+    /**
+     * @return configDir 当前生效的元数据版本
+     */
+    static std::shared_ptr<const MMSMetaDataManager> get(const std::string &configDir);
+
+    /**
+     * 从注册表中移除 configDir 对应的槽位, 用于回收不再使用的元数据
+     * 已经创建的引擎继续使用原来的槽位, 元数据在最后一个持有者释放后销毁; 之后再获取时重新加载
+     */
+    static void evict(const std::string &configDir);
+
+    /**
+     * 在后台线程重新加载 configDir 下的元数据, 加载成功后原子地发布为新版本, 调用本身立即返回
+     * 正在进行的解析继续使用各自的旧版本; 加载失败时保留旧版本, 异常通过返回的 future 抛出.
+     * 返回的 future 析构时不等待加载完成, 不关心结果时可以直接丢弃
+     * configDir 尚未加载或已被 evict 时不做加载, 下次获取槽位时会直接读取最新的文件
+     */
+    static std::future<void> reload(const std::string &configDir);
+};
+
+#endif //FREEMMS_MMSMETADATAREGISTRY_H
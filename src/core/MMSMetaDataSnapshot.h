@@ -0,0 +1,38 @@
+#ifndef FREEMMS_MMSMETADATASNAPSHOT_H
+#define FREEMMS_MMSMETADATASNAPSHOT_H
+
+#include <cstdint>
+#include "MMSMetaDataLayout.h"
+
+/**
+ * 元数据二进制快照格式, 由 mmsmetagen --snapshot 生成
+ * 快照就是 MMSMetaDataLayout.h 的各数组, MMSMetaDataManager 校验后直接在映射的文件上查找, 不做任何转换
+ *
+ * 文件布局(本机字节序, 4 字节对齐):
+ *   MetaSnapshotHeader
+ *   MetaLayoutTable[tableCount]
+ *   MetaLayoutEntry[entryCount]
+ *   int32_t[codeIndexCount]
+ *   MetaLayoutCode[sparseCodeCount]
+ *   uint32_t[seedCount]
+ *   MetaLayoutSlot[slotCount]
+ *   字符串池, 每个字符串以 0 结尾
+ */
+
+#define META_SNAPSHOT_MAGIC "FMMETA\0"
+#define META_SNAPSHOT_VERSION 2
+#define META_SNAPSHOT_FILE "metadata.snapshot"
+
+struct MetaSnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t tableCount;
+    uint32_t entryCount;
+    uint32_t codeIndexCount;
+    uint32_t sparseCodeCount;
+    uint32_t seedCount;
+    uint32_t slotCount;
+    uint32_t stringPoolSize;
+};
+
+#endif //FREEMMS_MMSMETADATASNAPSHOT_H
@@ -0,0 +1,25 @@
+#include "MMSName.h"
+
+#include <mutex>
+#include <unordered_set>
+
+using namespace std;
+
+/**
+ * 名字池有意不释放, 避免静态对象析构顺序导致仍在使用的 MMSName 悬空
+ * unordered_set 的元素地址在 rehash 后保持不变
+ */
+static unordered_set<string> &namePool() {
+    static auto *pool = new unordered_set<string>();
+    return *pool;
+}
+
+static mutex &namePoolMutex() {
+    static auto *m = new mutex();
+    return *m;
+}
+
+MMSName MMSName::intern(const std::string &name) {
+    lock_guard<mutex> lock(namePoolMutex());
+    return MMSName(namePool().insert(name).first->c_str());
+}
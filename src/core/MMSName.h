@@ -0,0 +1,101 @@
+#ifndef FREEMMS_MMSNAME_H
+#define FREEMMS_MMSNAME_H
+
+#include <cstring>
+#include <ostream>
+#include <string>
+
+/**
+ * 元数据名字的只读引用, 只有一个指针大小, 复制时不分配内存
+ * 引用的字符串以 0 结尾, 由元数据持有: 内置元数据在 .rodata 中, 快照在映射的文件中, json 元数据在
+ * MMSMetaDataManager 持有的字符串池中, intern() 的名字在进程级的名字池中且不会释放.
+ * 因此来自元数据的 MMSName 只在对应的 MMSMetaDataManager 存活期间有效, 解析结果会持有解析时的元数据版本
+ */
+class MMSName {
+private:
+    const char *ref;
+
+public:
+    /**
+     * 空名字
+     */
+    MMSName() : ref("") {}
+
+    /**
+     * 引用 name, 不复制, name 需要在 MMSName 的使用期间保持有效
+     */
+    explicit MMSName(const char *name) : ref(name) {}
+
+    /**
+     * 将 name 放入名字池, 相同内容的名字只保存一份
+     * 会加锁, 只应在常量初始化时调用, 不要在解析过程中调用
+     */
+    static MMSName intern(const std::string &name);
+
+    std::string str() const {
+        return ref;
+    }
+
+    operator std::string() const {
+        return ref;
+    }
+
+    const char *c_str() const {
+        return ref;
+    }
+
+    size_t length() const {
+        return strlen(ref);
+    }
+
+    bool empty() const {
+        return *ref == '\0';
+    }
+
+    friend bool operator==(const MMSName &lhs, const MMSName &rhs) {
+        // 同一份元数据中的名字通常指向同一位置, 先比较指针
+        return lhs.ref == rhs.ref || strcmp(lhs.ref, rhs.ref) == 0;
+    }
+};
+
+inline bool operator!=(const MMSName &lhs, const MMSName &rhs) {
+    return !(lhs == rhs);
+}
+
+inline bool operator==(const MMSName &lhs, const std::string &rhs) {
+    return rhs.compare(lhs.c_str()) == 0;
+}
+
+inline bool operator==(const std::string &lhs, const MMSName &rhs) {
+    return lhs.compare(rhs.c_str()) == 0;
+}
+
+inline bool operator!=(const MMSName &lhs, const std::string &rhs) {
+    return !(lhs == rhs);
+}
+
+inline bool operator!=(const std::string &lhs, const MMSName &rhs) {
+    return !(lhs == rhs);
+}
+
+inline bool operator==(const MMSName &lhs, const char *rhs) {
+    return strcmp(lhs.c_str(), rhs) == 0;
+}
+
+inline bool operator==(const char *lhs, const MMSName &rhs) {
+    return strcmp(lhs, rhs.c_str()) == 0;
+}
+
+inline bool operator!=(const MMSName &lhs, const char *rhs) {
+    return !(lhs == rhs);
+}
+
+inline bool operator!=(const char *lhs, const MMSName &rhs) {
+    return !(lhs == rhs);
+}
+
+inline std::ostream &operator<<(std::ostream &os, const MMSName &name) {
+    return os << name.c_str();
+}
+
+#endif //FREEMMS_MMSNAME_H
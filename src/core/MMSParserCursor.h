@@ -2,17 +2,54 @@
 #define FREEMMS_MMSPARSERCURSOR_H
 
 #include <cstddef>
+#include <stdexcept>
+#include <string>
+
+/**
+ * 数据截断或长度字段越界时抛出
+ */
+class MMSParseError : public std::runtime_error {
+public:
+    explicit MMSParseError(const std::string &what) : std::runtime_error(what) {}
+};
 
 typedef struct MMSParserCursor {
     const char *begin;
     size_t gOffset;
+    // 缓冲区结束位置(不含), 所有读取都不能越过该位置
+    const char *end;
 
     unsigned char operator*() const {
+        if (begin >= end) {
+            throw MMSParseError("mms data truncated at " + std::to_string(gOffset));
+        }
         return *begin;
     }
 
+    size_t remaining() const {
+        return begin < end ? end - begin : 0;
+    }
+
+    /**
+     * 校验剩余数据至少有 n 个字节, 长度前缀类的读取只需校验一次
+     */
+    void require(size_t n) const {
+        if (remaining() < n) {
+            throw MMSParseError("mms data truncated at " + std::to_string(gOffset) + ", need " + std::to_string(n)
+                                + " bytes but " + std::to_string(remaining()) + " left");
+        }
+    }
+
     MMSParserCursor offset(ptrdiff_t offset) const {
-        return {begin + offset, gOffset + offset};
+        return {begin + offset, gOffset + offset, end};
+    }
+
+    /**
+     * 返回只能读取前 n 个字节的游标, 用于长度前缀的字段
+     */
+    MMSParserCursor limit(size_t n) const {
+        require(n);
+        return {begin, gOffset, begin + n};
     }
 } cursor;
 
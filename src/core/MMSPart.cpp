@@ -1,6 +1,7 @@
 #include "MMSPart.h"
 #include <spdlog/spdlog.h>
 
+#include <strings.h>
 #include <utility>
 
 using namespace std;
@@ -9,40 +10,78 @@ using namespace spdlog;
 MMSPart::MMSPart() : _data(nullptr), _dataLen(0) {
 }
 
-MMSPart::~MMSPart() {
-    delete[] _data;
-}
+MMSPart::~MMSPart() = default;
 
-void MMSPart::assignData(char *dat, long len) {
+void MMSPart::assignData(const char *dat, long len) {
     this->_data = dat;
     this->_dataLen = len;
 }
 
-void MMSPart::assignFields(std::list<field> fields) {
+void MMSPart::assignFields(MMSPartHeaderList fields) {
     this->_header = std::move(fields);
 }
 
-MMSPart::MMSPart(const MMSPart &part) {
-    char *d = static_cast<char *>(malloc(sizeof(char) * part._dataLen));
-    memcpy(d, part._data, sizeof(char) * part._dataLen);
-    this->_data = part._data;
-    this->_dataLen = part._dataLen;
-    this->_header = part._header;
-}
-
-MMSPart::MMSPart(MMSPart &&part) {
-    this->_data = part._data;
-    this->_dataLen = part._dataLen;
-    this->_header = part._header;
-
+MMSPart::MMSPart(MMSPart &&part) noexcept
+        : _header(std::move(part._header)), _data(part._data), _dataLen(part._dataLen) {
     part._data = nullptr;
     part._dataLen = 0;
 }
 
-const std::list<field> &MMSPart::header() {
+MMSPart &MMSPart::operator=(MMSPart &&part) noexcept {
+    if (this != &part) {
+        this->_header = std::move(part._header);
+        this->_data = part._data;
+        this->_dataLen = part._dataLen;
+        part._data = nullptr;
+        part._dataLen = 0;
+    }
+    return *this;
+}
+
+const MMSPartHeaderList &MMSPart::header() const {
     return _header;
 }
 
-const char *MMSPart::data() {
+const char *MMSPart::data() const {
     return _data;
 }
+
+/**
+ * 从 part 的 Content-Type 值(如 text/plain;Charset=UTF-8,)中取出 Charset 参数
+ * @return 不是 text 类型或没有 Charset 参数时返回空串
+ */
+static string findTextCharset(const string &contentType) {
+    if (strncasecmp(contentType.c_str(), "text/", 5) != 0) {
+        return "";
+    }
+    size_t pos = contentType.find(';');
+    while (pos != string::npos) {
+        size_t begin = pos + 1;
+        size_t end = contentType.find(',', begin);
+        size_t eq = contentType.find('=', begin);
+        if (eq != string::npos && eq < end && eq - begin == 7
+            && strncasecmp(contentType.c_str() + begin, "charset", 7) == 0) {
+            return contentType.substr(eq + 1, end == string::npos ? string::npos : end - eq - 1);
+        }
+        pos = end;
+    }
+    return "";
+}
+
+std::string MMSPart::text() const {
+    if (_data == nullptr) {
+        return "";
+    }
+    for (auto &f: _header) {
+        if (f.name.value != "Content-Type") {
+            continue;
+        }
+        string charset = findTextCharset(f.value.value);
+        string out;
+        if (!charset.empty() && MMSCharsetConverter::toUTF8(charset, _data, (size_t) _dataLen, out)) {
+            return out;
+        }
+        break;
+    }
+    return string(_data, (size_t) _dataLen);
+}
@@ -1,34 +1,47 @@
 #ifndef FREEMMS_MMSPART_H
 #define FREEMMS_MMSPART_H
 
-#include <list>
 #include "Field.h"
 
+/**
+ * 只能移动不能复制, 移动时只转移头字段和数据指针
+ */
 class MMSPart {
 private:
-    std::list<field> _header;
-    char *_data;
+    MMSPartHeaderList _header;
+    // 指向所属 MMSInfo 持有的 PDU 缓冲区, 不拥有该内存
+    const char *_data;
     long _dataLen;
 public:
     MMSPart();
 
-    MMSPart(const MMSPart &part);
+    MMSPart(const MMSPart &part) = delete;
 
-    MMSPart(MMSPart &&part);
+    MMSPart &operator=(const MMSPart &part) = delete;
+
+    MMSPart(MMSPart &&part) noexcept;
+
+    MMSPart &operator=(MMSPart &&part) noexcept;
 
     ~MMSPart();
 
-    const std::list<field> &header();
+    const MMSPartHeaderList &header() const;
 
-    const char *data();
+    const char *data() const;
 
     long dataLen() const {
         return _dataLen;
     }
 
-    void assignData(char *data, long len);
+    /**
+     * @return 数据的 UTF-8 文本. Content-Type 为 text 类型且声明了 Charset 时按该字符集转换,
+     * 常见字符集直接解码, 其余经 iconv; 不是文本 part 或无法转换时返回原始字节
+     */
+    std::string text() const;
+
+    void assignData(const char *data, long len);
 
-    void assignFields(std::list<field> fields);
+    void assignFields(MMSPartHeaderList fields);
 };
 
 #endif //FREEMMS_MMSPART_H
@@ -0,0 +1,127 @@
+#include "MMSPerfectHash.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <unordered_set>
+
+using namespace std;
+
+static const uint32_t MAX_SEED = 1u << 20;
+
+static inline unsigned char lowerAscii(unsigned char ch) {
+    return ch >= 'A' && ch <= 'Z' ? (unsigned char) (ch + ('a' - 'A')) : ch;
+}
+
+/**
+ * lhs 以 0 结尾, rhs 中可能含有 0, 不会读取 lhs 结尾之后的内容
+ */
+static bool equalsIgnoreCase(const char *lhs, const string &rhs) {
+    for (size_t i = 0; i < rhs.length(); i++) {
+        if (lhs[i] == '\0' || lowerAscii((unsigned char) lhs[i]) != lowerAscii((unsigned char) rhs[i])) {
+            return false;
+        }
+    }
+    return lhs[rhs.length()] == '\0';
+}
+
+/**
+ * 带种子的 FNV-1a, 按小写字母计算
+ */
+uint32_t MMSPerfectHash::hash(const char *key, size_t len, uint32_t seed) {
+    uint32_t h = 2166136261u ^ (seed * 0x9E3779B9u);
+    for (size_t i = 0; i < len; i++) {
+        h ^= lowerAscii((unsigned char) key[i]);
+        h *= 16777619u;
+    }
+    h ^= h >> 15;
+    h *= 0x2C1B3C6Du;
+    h ^= h >> 12;
+    return h;
+}
+
+void MMSPerfectHash::build(const char *pool, const vector<pair<uint32_t, int>> &entries,
+                           vector<uint32_t> &seeds, vector<MetaLayoutSlot> &slots) {
+    vector<pair<uint32_t, int>> keys;
+    unordered_set<string> seen;
+    for (auto &entry: entries) {
+        string key = pool + entry.first;
+        transform(key.begin(), key.end(), key.begin(), lowerAscii);
+        if (seen.insert(key).second) {
+            keys.push_back(entry);
+        }
+    }
+
+    seeds.assign(keys.size() / 2 + 1, 0);
+    slots.assign(keys.size() + keys.size() / 4 + 1, {0, -1});
+
+    vector<vector<size_t>> buckets(seeds.size());
+    for (size_t i = 0; i < keys.size(); i++) {
+        const char *key = pool + keys[i].first;
+        buckets[hash(key, strlen(key), 0) % buckets.size()].push_back(i);
+    }
+
+    // 先放置大桶, 空槽多时更容易找到种子
+    vector<size_t> order(buckets.size());
+    for (size_t i = 0; i < order.size(); i++) {
+        order[i] = i;
+    }
+    stable_sort(order.begin(), order.end(), [&buckets](size_t lhs, size_t rhs) -> bool {
+        return buckets[lhs].size() > buckets[rhs].size();
+    });
+
+    vector<size_t> placed;
+    for (size_t b: order) {
+        if (buckets[b].empty()) {
+            break;
+        }
+
+        uint32_t seed = 1;
+        for (; seed < MAX_SEED; seed++) {
+            placed.clear();
+            bool ok = true;
+            for (size_t i: buckets[b]) {
+                const char *key = pool + keys[i].first;
+                size_t slot = hash(key, strlen(key), seed) % slots.size();
+                if (slots[slot].value >= 0
+                    || std::find(placed.begin(), placed.end(), slot) != placed.end()) {
+                    ok = false;
+                    break;
+                }
+                placed.push_back(slot);
+            }
+            if (ok) {
+                break;
+            }
+        }
+        if (seed == MAX_SEED) {
+            throw runtime_error("can not build perfect hash");
+        }
+
+        seeds[b] = seed;
+        for (size_t i = 0; i < placed.size(); i++) {
+            slots[placed[i]] = {keys[buckets[b][i]].first, keys[buckets[b][i]].second};
+        }
+    }
+}
+
+void MMSPerfectHash::attach(const uint32_t *seeds, uint32_t seedCount, const MetaLayoutSlot *slots,
+                            uint32_t slotCount, const char *stringPool) {
+    this->seeds = seeds;
+    this->seedCount = seedCount;
+    this->slots = slots;
+    this->slotCount = slotCount;
+    this->stringPool = stringPool;
+}
+
+int MMSPerfectHash::find(const std::string &key) const {
+    if (this->seedCount == 0 || this->slotCount == 0) {
+        return -1;
+    }
+    uint32_t seed = this->seeds[hash(key.c_str(), key.length(), 0) % this->seedCount];
+    const MetaLayoutSlot &slot = this->slots[hash(key.c_str(), key.length(), seed) % this->slotCount];
+    if (slot.value < 0 || !equalsIgnoreCase(this->stringPool + slot.key, key)) {
+        return -1;
+    }
+    return slot.value;
+}
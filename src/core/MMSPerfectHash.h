@@ -0,0 +1,50 @@
+#ifndef FREEMMS_MMSPERFECTHASH_H
+#define FREEMMS_MMSPERFECTHASH_H
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+#include "MMSMetaDataLayout.h"
+
+/**
+ * 名字到编码的静态完美哈希表(hash and displace)
+ * 种子和槽位由 MMSMetaDataBuilder 在生成元数据时计算, 与条目一起保存在内置表和快照中, 加载时不再构建
+ * 每个桶记录一个种子, 使桶内的名字落到互不冲突的槽位, 查找只需计算两次哈希和一次字符串比较
+ * 名字按 ASCII 不区分大小写比较, 与 MIME 中字段名、媒体类型和字符集名的约定一致
+ */
+class MMSPerfectHash {
+private:
+    const uint32_t *seeds = nullptr;
+    uint32_t seedCount = 0;
+    const MetaLayoutSlot *slots = nullptr;
+    uint32_t slotCount = 0;
+    const char *stringPool = nullptr;
+
+    static uint32_t hash(const char *key, size_t len, uint32_t seed);
+
+public:
+    /**
+     * 计算种子和槽位, 重复的名字(不区分大小写)以第一次出现的为准
+     * @param stringPool 以 0 结尾的字符串连续存放的字符串池
+     * @param entries 名字在 stringPool 中的偏移和编码
+     * @param seeds 桶 -> 种子
+     * @param slots 槽位 -> 名字和编码, value 为 -1 表示空槽
+     * @throw std::runtime_error 找不到可用的种子
+     */
+    static void build(const char *stringPool, const std::vector<std::pair<uint32_t, int>> &entries,
+                      std::vector<uint32_t> &seeds, std::vector<MetaLayoutSlot> &slots);
+
+    /**
+     * 指向 build 生成的种子和槽位, 它们和字符串池需要在本对象的使用期间保持有效
+     */
+    void attach(const uint32_t *seeds, uint32_t seedCount, const MetaLayoutSlot *slots, uint32_t slotCount,
+                const char *stringPool);
+
+    /**
+     * @return 名字对应的编码, 找不到时返回 -1
+     */
+    int find(const std::string &key) const;
+};
+
+#endif //FREEMMS_MMSPERFECTHASH_H
@@ -0,0 +1,226 @@
+#ifndef FREEMMS_MMSSMALLVECTOR_H
+#define FREEMMS_MMSSMALLVECTOR_H
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/**
+ * 带内联存储的连续容器, 元素个数不超过 N 时不分配堆内存, 超过后整体搬到堆上
+ * 用于保存头字段, 典型的 PDU 头只有 10-20 个字段
+ */
+template<typename T, size_t N>
+class MMSSmallVector {
+public:
+    typedef T value_type;
+    typedef size_t size_type;
+    typedef T &reference;
+    typedef const T &const_reference;
+    typedef T *iterator;
+    typedef const T *const_iterator;
+
+private:
+    T *_begin;
+    size_t _size;
+    size_t _capacity;
+    typename std::aligned_storage<sizeof(T), alignof(T)>::type _inline[N];
+
+    T *inlineData() {
+        return reinterpret_cast<T *>(_inline);
+    }
+
+    bool isInline() const {
+        return _begin == reinterpret_cast<const T *>(_inline);
+    }
+
+    void destroyAll() {
+        for (size_t i = 0; i < _size; i++) {
+            _begin[i].~T();
+        }
+        _size = 0;
+    }
+
+    void releaseHeap() {
+        if (!isInline()) {
+            ::operator delete(_begin);
+            _begin = inlineData();
+            _capacity = N;
+        }
+    }
+
+    void grow(size_t minCapacity) {
+        size_t capacity = _capacity * 2 > minCapacity ? _capacity * 2 : minCapacity;
+        T *data = static_cast<T *>(::operator new(capacity * sizeof(T)));
+        size_t i = 0;
+        try {
+            for (; i < _size; i++) {
+                new(data + i) T(std::move_if_noexcept(_begin[i]));
+            }
+        } catch (...) {
+            // 复制构造抛出时原元素保持不变, 只回收新内存块
+            while (i > 0) {
+                data[--i].~T();
+            }
+            ::operator delete(data);
+            throw;
+        }
+        for (i = 0; i < _size; i++) {
+            _begin[i].~T();
+        }
+        releaseHeap();
+        _begin = data;
+        _capacity = capacity;
+    }
+
+    /**
+     * 从 other 接管元素, other 在堆上时直接接管其内存
+     */
+    void takeFrom(MMSSmallVector &other) {
+        if (other.isInline()) {
+            for (size_t i = 0; i < other._size; i++) {
+                new(_begin + i) T(std::move(other._begin[i]));
+            }
+            _size = other._size;
+            other.destroyAll();
+        } else {
+            _begin = other._begin;
+            _size = other._size;
+            _capacity = other._capacity;
+            other._begin = other.inlineData();
+            other._size = 0;
+            other._capacity = N;
+        }
+    }
+
+public:
+    MMSSmallVector() : _begin(inlineData()), _size(0), _capacity(N) {}
+
+    MMSSmallVector(const MMSSmallVector &other) : MMSSmallVector() {
+        reserve(other._size);
+        for (const T &value: other) {
+            new(_begin + _size) T(value);
+            _size++;
+        }
+    }
+
+    MMSSmallVector(MMSSmallVector &&other) noexcept(std::is_nothrow_move_constructible<T>::value)
+            : MMSSmallVector() {
+        takeFrom(other);
+    }
+
+    ~MMSSmallVector() {
+        destroyAll();
+        releaseHeap();
+    }
+
+    MMSSmallVector &operator=(const MMSSmallVector &other) {
+        if (this != &other) {
+            MMSSmallVector copy(other);
+            *this = std::move(copy);
+        }
+        return *this;
+    }
+
+    MMSSmallVector &operator=(MMSSmallVector &&other) noexcept(std::is_nothrow_move_constructible<T>::value) {
+        if (this != &other) {
+            destroyAll();
+            releaseHeap();
+            takeFrom(other);
+        }
+        return *this;
+    }
+
+    void reserve(size_t capacity) {
+        if (capacity > _capacity) {
+            grow(capacity);
+        }
+    }
+
+    template<typename... Args>
+    T &emplace_back(Args &&... args) {
+        if (_size == _capacity) {
+            // 参数可能引用本容器中的元素, 先构造再扩容
+            T value(std::forward<Args>(args)...);
+            grow(_size + 1);
+            new(_begin + _size) T(std::move(value));
+        } else {
+            new(_begin + _size) T(std::forward<Args>(args)...);
+        }
+        return _begin[_size++];
+    }
+
+    void push_back(const T &value) {
+        emplace_back(value);
+    }
+
+    void push_back(T &&value) {
+        emplace_back(std::move(value));
+    }
+
+    void clear() {
+        destroyAll();
+    }
+
+    size_t size() const {
+        return _size;
+    }
+
+    size_t capacity() const {
+        return _capacity;
+    }
+
+    bool empty() const {
+        return _size == 0;
+    }
+
+    T *data() {
+        return _begin;
+    }
+
+    const T *data() const {
+        return _begin;
+    }
+
+    iterator begin() {
+        return _begin;
+    }
+
+    iterator end() {
+        return _begin + _size;
+    }
+
+    const_iterator begin() const {
+        return _begin;
+    }
+
+    const_iterator end() const {
+        return _begin + _size;
+    }
+
+    T &operator[](size_t i) {
+        return _begin[i];
+    }
+
+    const T &operator[](size_t i) const {
+        return _begin[i];
+    }
+
+    T &front() {
+        return _begin[0];
+    }
+
+    const T &front() const {
+        return _begin[0];
+    }
+
+    T &back() {
+        return _begin[_size - 1];
+    }
+
+    const T &back() const {
+        return _begin[_size - 1];
+    }
+};
+
+#endif //FREEMMS_MMSSMALLVECTOR_H
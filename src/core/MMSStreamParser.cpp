@@ -0,0 +1,172 @@
+#include "MMSStreamParser.h"
+#include <spdlog/spdlog.h>
+
+using namespace std;
+
+MMSStreamParser::MMSStreamParser(const MMSMetaDataManager &metaDataManager, MMSStreamListener &listener)
+        : metaDataManager(metaDataManager),
+          listener(listener),
+          emptyData(),
+          decoder(metaDataManager, emptyData),
+          state(HEADER_FIELD),
+          streamOffset(0),
+          hasBody(false),
+          partLeft(0),
+          partHeaderLen(0),
+          partDataLen(0) {
+}
+
+MMSStreamParser::MMSStreamParser(std::shared_ptr<const MMSMetaDataManager> metaDataManager,
+                                 MMSStreamListener &listener)
+        : MMSStreamParser(*metaDataManager, listener) {
+    this->metaDataHolder = std::move(metaDataManager);
+}
+
+void MMSStreamParser::feed(const char *data, size_t len) {
+    if (state == END) {
+        return;
+    }
+
+    // 有挂起的字段时只按需补齐, 字段完整后剩余数据直接从 data 解析, part 数据不经过 pending
+    while (!pending.empty() && len > 0) {
+        size_t take = min(len, pendingStep());
+        pending.insert(pending.end(), data, data + take);
+        data += take;
+        len -= take;
+
+        size_t used = process(pending.data(), pending.size());
+        pending.erase(pending.begin(), pending.begin() + (ptrdiff_t) used);
+        checkPending();
+    }
+
+    if (pending.empty() && len > 0) {
+        size_t used = process(data, len);
+        pending.assign(data + used, data + len);
+        checkPending();
+    }
+}
+
+size_t MMSStreamParser::pendingStep() const {
+    switch (state) {
+        case PART_HEADERS:
+            return (size_t) partHeaderLen - pending.size();
+        case PART_COUNT:
+        case PART_HEADER_LEN:
+        case PART_DATA_LEN:
+            return 1;
+        default:
+            // 头字段长度未知, 每次至少翻倍, 重复探测的总开销与字段长度成线性
+            return max(pending.size(), (size_t) 64);
+    }
+}
+
+void MMSStreamParser::checkPending() const {
+    if (pending.size() > MAX_PENDING_UNIT) {
+        throw MMSParseError("pending field exceeds " + to_string(MAX_PENDING_UNIT) + " bytes, start "
+                            + to_string(streamOffset));
+    }
+}
+
+void MMSStreamParser::endPart() {
+    listener.onPartEnd();
+    if (--partLeft > 0) {
+        state = PART_HEADER_LEN;
+    } else {
+        state = END;
+        listener.onEnd();
+    }
+}
+
+size_t MMSStreamParser::process(const char *data, size_t len) {
+    size_t pos = 0;
+    while (pos < len && state != END) {
+        const char *p = data + pos;
+        size_t avail = len - pos;
+        size_t used;
+
+        if (state == HEADER_FIELD) {
+            size_t valueLen;
+            if (!MMSHexDataParser::measureHeaderValue(p + 1, avail - 1, valueLen)) {
+                break;
+            }
+
+            used = 1 + valueLen;
+            unsigned char headerFieldCode = *p;
+            size_t decodeLen;
+            field f = decoder.parseHeaderField(headerFieldCode, {p + 1, streamOffset + 1, p + used}, decodeLen);
+            listener.onHeaderField(f);
+
+            if ((headerFieldCode & 0x7F) == FIELD_MESSAGE_TYPE && f.typed.symbol == "M-Retrieve-Conf") {
+                hasBody = true;
+            }
+            if ((headerFieldCode & 0x7F) == FIELD_CONTENT_TYPE) {
+                listener.onHeaderEnd();
+                if (hasBody) {
+                    state = PART_COUNT;
+                } else {
+                    state = END;
+                    listener.onEnd();
+                }
+            }
+        } else if (state == PART_COUNT || state == PART_HEADER_LEN || state == PART_DATA_LEN) {
+            if (!MMSHexDataParser::measureUIntVar(p, avail, used)) {
+                if (avail >= 5) {
+                    throw MMSParseError("invalid uintvar, start " + to_string(streamOffset));
+                }
+                break;
+            }
+
+            size_t uvLen;
+            long v = MMSHexDataParser::readUIntVar({p, streamOffset, p + used}, uvLen);
+            if (state == PART_COUNT) {
+                spdlog::debug("parse body part count is {}", v);
+                partLeft = v;
+                state = PART_HEADER_LEN;
+                if (partLeft == 0) {
+                    state = END;
+                    listener.onEnd();
+                }
+            } else if (state == PART_HEADER_LEN) {
+                if ((unsigned long) v > MAX_PENDING_UNIT) {
+                    throw MMSParseError("part header length " + to_string(v) + " exceeds "
+                                        + to_string(MAX_PENDING_UNIT) + ", start " + to_string(streamOffset));
+                }
+                partHeaderLen = v;
+                state = PART_DATA_LEN;
+            } else {
+                partDataLen = v;
+                state = PART_HEADERS;
+            }
+        } else if (state == PART_HEADERS) {
+            if (avail < (size_t) partHeaderLen) {
+                break;
+            }
+
+            MMSPartHeaderList headerFields = decoder.parsePartHeaders(metaDataManager, {p, streamOffset, p + avail},
+                                                                      partHeaderLen);
+            listener.onPartBegin(headerFields, partDataLen);
+            used = partHeaderLen;
+            state = PART_DATA;
+            if (partDataLen == 0) {
+                endPart();
+            }
+        } else {
+            used = min(avail, (size_t) partDataLen);
+            listener.onPartData(p, used);
+            partDataLen -= (long) used;
+            if (partDataLen == 0) {
+                endPart();
+            }
+        }
+
+        pos += used;
+        streamOffset += used;
+    }
+
+    if (state == END && pos < len) {
+        spdlog::warn("ignore {} bytes after end of mms, start {}", len - pos, streamOffset);
+        streamOffset += len - pos;
+        pos = len;
+    }
+    return pos;
+}
@@ -0,0 +1,95 @@
+#ifndef FREEMMS_MMSSTREAMPARSER_H
+#define FREEMMS_MMSSTREAMPARSER_H
+
+#include <memory>
+#include <vector>
+#include <MMSHexData.h>
+#include "MMSMetaDataManager.h"
+#include "MMSHexDataParser.h"
+#include "Field.h"
+
+/**
+ * 流式解析回调, 字段/part 边界一旦完整即回调
+ */
+class MMSStreamListener {
+public:
+    virtual ~MMSStreamListener() = default;
+
+    virtual void onHeaderField(const field & /*f*/) {}
+
+    virtual void onHeaderEnd() {}
+
+    virtual void onPartBegin(const MMSPartHeaderList & /*header*/, long /*dataLen*/) {}
+
+    virtual void onPartData(const char * /*data*/, size_t /*len*/) {}
+
+    virtual void onPartEnd() {}
+
+    virtual void onEnd() {}
+};
+
+/**
+ * 推送式增量解析器
+ *
+ * 数据按任意大小的分块通过 feed() 推入, 遇到不完整的字段(如 uintvar 或未结束的字符串)时挂起等待后续数据.
+ * 只缓存尚未完整的字段, part 数据直接透传给 onPartData, 不做整体缓存.
+ * 单个挂起的字段或 part 头超过 MAX_PENDING_UNIT 时抛出 MMSParseError, 避免畸形数据导致无限缓存
+ */
+class MMSStreamParser {
+private:
+    enum State {
+        HEADER_FIELD,
+        PART_COUNT,
+        PART_HEADER_LEN,
+        PART_DATA_LEN,
+        PART_HEADERS,
+        PART_DATA,
+        END
+    };
+
+    // 通过 shared_ptr 构造时持有的元数据版本
+    std::shared_ptr<const MMSMetaDataManager> metaDataHolder;
+    const MMSMetaDataManager &metaDataManager;
+    MMSStreamListener &listener;
+    MMSHexData emptyData;
+    MMSHexDataParser decoder;
+
+    // 挂起的单个头字段或 part 头的最大长度
+    static const size_t MAX_PENDING_UNIT = 64 * 1024;
+
+    State state;
+    std::vector<char> pending;
+    size_t streamOffset;
+    bool hasBody;
+    long partLeft;
+    long partHeaderLen;
+    long partDataLen;
+
+    size_t process(const char *data, size_t len);
+
+    size_t pendingStep() const;
+
+    void checkPending() const;
+
+    void endPart();
+
+public:
+    MMSStreamParser(const MMSMetaDataManager &metaDataManager, MMSStreamListener &listener);
+
+    /**
+     * 持有 metaDataManager, 解析器在整个生命周期内使用该版本的元数据
+     */
+    MMSStreamParser(std::shared_ptr<const MMSMetaDataManager> metaDataManager, MMSStreamListener &listener);
+
+    /**
+     * 推入一段数据, 已经完整的字段中出现越界的长度时抛出 MMSParseError
+     */
+    void feed(const char *data, size_t len);
+
+    bool finished() const {
+        return state == END;
+    }
+};
+
+
+#endif //FREEMMS_MMSSTREAMPARSER_H
@@ -1,18 +1,33 @@
 #ifndef FREEMMS_MMSENGINE_H
 #define FREEMMS_MMSENGINE_H
 
+#include <memory>
 #include <string>
 #include "MMSHexData.h"
+#include "MMSParseOptions.h"
 #include "../MMSMetaDataManager.h"
+#include "../MMSMetaDataRegistry.h"
+#include "../MMSInfo.h"
+#include "../MMSStreamParser.h"
 
 class MMSEngine {
 private:
-    MMSMetaDataManager* metaDataManager;
-    void initMMSMetaDataManager(std::string configDir);
+    // 由 MMSMetaDataRegistry 按配置目录在进程内共享, 每次解析开始时取当前版本
+    std::shared_ptr<MMSMetaDataSlot> metaDataSlot;
+    void initMMSMetaDataManager(const std::string &configDir);
 
 public:
+    /**
+     * 使用编译进库的内置元数据
+     */
     MMSEngine();
     ~MMSEngine();
+
+    /**
+     * 使用 configDir 下的 json 元数据覆盖内置元数据
+     * 同一 configDir 在进程内只加载一次, 之后创建引擎不再访问文件系统
+     * 通过 MMSMetaDataRegistry::reload 重新加载后, 之后开始的解析自动使用新版本
+     */
     explicit MMSEngine(std::string configDir);
 
     std::string convert2Plain(const std::string &mmsHexFilePath);
@@ -21,6 +36,23 @@ public:
     void convert2PlainFile(const std::string &mmsHexFilePath, const std::string &outFile, bool withBinaryBody);
     void convert2PlainDirectory(const std::string &mmsHexFilePath, const std::string &outDir);
 
+    /**
+     * 直接解析内存中的 MMS PDU, 不经过文件系统
+     * 返回的 MMSInfo 由调用方负责 delete, 其中各 part 的 data() 指向 data 所在内存,
+     * 因此 data 必须在返回的 MMSInfo 释放之前保持有效
+     *
+     * @return 解析结果, data 为空或数据被截断时返回 nullptr
+     */
+    MMSInfo *parse(const void *data, std::size_t length);
+
+    MMSInfo *parse(const void *data, std::size_t length, const MMSParseOptions &options);
+
+    /**
+     * 创建分块推送的流式解析器, 由调用方负责 delete
+     * 解析器在整个生命周期内使用创建时的元数据版本
+     */
+    MMSStreamParser *createStreamParser(MMSStreamListener &listener);
+
     MMSHexData *convert2mmsHex(const std::string &mmsPlain);
 
 };
@@ -0,0 +1,22 @@
+#ifndef FREEMMS_MMSPARSEOPTIONS_H
+#define FREEMMS_MMSPARSEOPTIONS_H
+
+#include <set>
+#include <string>
+
+struct MMSParseOptions {
+    /**
+     * 只解析 PDU 头并记录 body 起始位置, part 表在第一次调用 MMSInfo::body() 时才解码
+     */
+    bool lazyBody = false;
+
+    /**
+     * 需要的头字段名, 如 {"Message-ID", "From", "To"}, 为空时解析全部头字段
+     * 非空时其余字段按长度跳过不做解码, 且不解析 body. To, Cc, Bcc 每个地址一个字段, 收集到头结束为止;
+     * 其余字段只取第一次出现的值, 不需要 To/Cc/Bcc 时全部取到后立即停止
+     */
+    std::set<std::string> headerFields;
+};
+
+
+#endif //FREEMMS_MMSPARSEOPTIONS_H
@@ -0,0 +1,152 @@
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "MMSMetaDataBuilder.h"
+#include "MMSMetaDataSnapshot.h"
+
+using namespace std;
+
+/**
+ * 将 metadata 目录下的 json 元数据表生成为编译进 freemms_core 的 constexpr 数组(布局见 MMSMetaDataLayout.h),
+ * 或者生成可被 mmap 直接加载的二进制快照
+ *
+ * 用法: mmsmetagen <metadata dir> <output cpp>
+ *      mmsmetagen --snapshot <metadata dir> <output snapshot>
+ */
+
+static string quote(const char *s) {
+    string result = "\"";
+    for (; *s != '\0'; s++) {
+        if (*s == '"' || *s == '\\') {
+            result.push_back('\\');
+        }
+        result.push_back(*s);
+    }
+    result.push_back('"');
+    return result;
+}
+
+template<typename T>
+static void write(ofstream &o, const vector<T> &items) {
+    o.write(reinterpret_cast<const char *>(items.data()), (streamsize) (items.size() * sizeof(T)));
+}
+
+static int generateSnapshot(const MMSMetaDataBuilder &builder, const string &outFile) {
+    MetaSnapshotHeader header = {};
+    memcpy(header.magic, META_SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = META_SNAPSHOT_VERSION;
+    header.tableCount = (uint32_t) builder.tables.size();
+    header.entryCount = (uint32_t) builder.entries.size();
+    header.codeIndexCount = (uint32_t) builder.codeIndex.size();
+    header.sparseCodeCount = (uint32_t) builder.sparseCodes.size();
+    header.seedCount = (uint32_t) builder.seeds.size();
+    header.slotCount = (uint32_t) builder.slots.size();
+    header.stringPoolSize = (uint32_t) builder.stringPool.size();
+
+    ofstream o(outFile, ios::binary);
+    if (!o.is_open()) {
+        cerr << "can not write file " << outFile << endl;
+        return -1;
+    }
+    o.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    write(o, builder.tables);
+    write(o, builder.entries);
+    write(o, builder.codeIndex);
+    write(o, builder.sparseCodes);
+    write(o, builder.seeds);
+    write(o, builder.slots);
+    write(o, builder.stringPool);
+    return o.good() ? 0 : -1;
+}
+
+static int generateSources(const MMSMetaDataBuilder &builder, const string &configDir, const string &outFile) {
+    stringstream out;
+    out << "// generated by mmsmetagen from " << configDir << ", do not edit\n\n"
+        << "#include \"MMSMetaDataBuiltin.h\"\n\n";
+
+    // 每个字符串单独一个字面量, 避免 \0 与后面的数字连成八进制转义
+    out << "static constexpr char stringPool[] =\n";
+    for (size_t i = 0; i < builder.stringPool.size(); i += strlen(&builder.stringPool[i]) + 1) {
+        out << "        " << quote(&builder.stringPool[i]) << " \"\\0\"\n";
+    }
+    out << "        \"\";\n\n";
+
+    out << "static constexpr MetaLayoutTable tables[] = {\n";
+    for (auto &table: builder.tables) {
+        out << "        {" << quote(table.file) << ", " << table.firstEntry << ", " << table.entryCount << ", "
+            << table.firstCodeIndex << ", " << table.codeIndexCount << ", "
+            << table.firstSparseCode << ", " << table.sparseCodeCount << ", "
+            << table.firstSeed << ", " << table.seedCount << ", " << table.firstSlot << ", " << table.slotCount << "},\n";
+    }
+    out << "};\n\n";
+
+    out << "static constexpr MetaLayoutEntry entries[] = {\n";
+    for (auto &entry: builder.entries) {
+        out << "        {" << entry.value << ", " << entry.name << ", " << entry.version << ", "
+            << entry.displayName << "},\n";
+    }
+    out << "};\n\n";
+
+    out << "static constexpr int32_t codeIndex[] = {";
+    for (size_t i = 0; i < builder.codeIndex.size(); i++) {
+        out << (i % 16 == 0 ? "\n        " : " ") << builder.codeIndex[i] << ",";
+    }
+    // 数组不能为空, 空表时放一个不会被访问的占位元素
+    out << (builder.codeIndex.empty() ? "\n        -1,\n};\n\n" : "\n};\n\n");
+
+    out << "static constexpr MetaLayoutCode sparseCodes[] = {\n";
+    for (auto &code: builder.sparseCodes) {
+        out << "        {" << code.code << ", " << code.entry << "},\n";
+    }
+    out << (builder.sparseCodes.empty() ? "        {0, 0},\n};\n\n" : "};\n\n");
+
+    out << "static constexpr uint32_t seeds[] = {";
+    for (size_t i = 0; i < builder.seeds.size(); i++) {
+        out << (i % 16 == 0 ? "\n        " : " ") << builder.seeds[i] << ",";
+    }
+    out << (builder.seeds.empty() ? "\n        0,\n};\n\n" : "\n};\n\n");
+
+    out << "static constexpr MetaLayoutSlot slots[] = {\n";
+    for (auto &slot: builder.slots) {
+        out << "        {" << slot.key << ", " << slot.value << "},\n";
+    }
+    out << (builder.slots.empty() ? "        {0, -1},\n};\n\n" : "};\n\n");
+
+    out << "const MetaLayout builtinMetaData = {\n"
+        << "        tables, " << builder.tables.size() << ", entries, codeIndex, sparseCodes, seeds, slots, stringPool\n"
+        << "};\n";
+
+    ofstream o(outFile);
+    if (!o.is_open()) {
+        cerr << "can not write file " << outFile << endl;
+        return -1;
+    }
+    o << out.str();
+    return 0;
+}
+
+int main(int argc, const char **argv) {
+    bool snapshot = argc == 4 && string(argv[1]) == "--snapshot";
+    if (argc != 3 && !snapshot) {
+        cerr << "usage: " << argv[0] << " <metadata dir> <output cpp>" << endl;
+        cerr << "       " << argv[0] << " --snapshot <metadata dir> <output snapshot>" << endl;
+        return -1;
+    }
+
+    string configDir = snapshot ? argv[2] : argv[1];
+    string outFile = snapshot ? argv[3] : argv[2];
+    MMSMetaDataBuilder builder;
+    try {
+        for (size_t i = 0; i < MMSMetaDataBuilder::META_FILE_COUNT; i++) {
+            builder.addJsonFile(configDir, MMSMetaDataBuilder::META_FILES[i]);
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return -1;
+    }
+    return snapshot ? generateSnapshot(builder, outFile) : generateSources(builder, configDir, outFile);
+}
@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+#include <memory>
+#include "MMSEngine.h"
+#include "../MMSCharsetConverter.h"
+
+using namespace std;
+
+TEST(CharsetTest, ConvertToUTF8) {
+    string text;
+    ASSERT_TRUE(MMSCharsetConverter::toUTF8("GB2312", "\xCE\xC4", 2, text));
+    EXPECT_EQ(text, "\xE6\x96\x87");
+
+    // 复用缓存的转换器
+    ASSERT_TRUE(MMSCharsetConverter::toUTF8("GB2312", "\xD6\xD0", 2, text));
+    EXPECT_EQ(text, "\xE4\xB8\xAD");
+}
+
+TEST(CharsetTest, UnsupportedCharset) {
+    string text = "unchanged";
+    EXPECT_FALSE(MMSCharsetConverter::toUTF8("X-NOT-A-CHARSET", "abc", 3, text));
+    EXPECT_FALSE(MMSCharsetConverter::toUTF8("X-NOT-A-CHARSET", "abc", 3, text));
+    EXPECT_EQ(text, "unchanged");
+}
+
+TEST(CharsetTest, NativeDecoders) {
+    string text;
+    ASSERT_TRUE(MMSCharsetConverter::toUTF8("US-ASCII", "Hello, MMS world", 16, text));
+    EXPECT_EQ(text, "Hello, MMS world");
+    ASSERT_TRUE(MMSCharsetConverter::toUTF8("ISO_8859-1:1987", "caf\xE9 cr\xE8me br\xFBl\xE9", 16, text));
+    EXPECT_EQ(text, "caf\xC3\xA9 cr\xC3\xA8me br\xC3\xBBl\xC3\xA9");
+    ASSERT_TRUE(MMSCharsetConverter::toUTF8("ISO-10646-UCS-2", string("\x00H\x4E\x2D\x65\x87", 6).data(), 6, text));
+    EXPECT_EQ(text, "H\xE4\xB8\xAD\xE6\x96\x87");
+    ASSERT_TRUE(MMSCharsetConverter::toUTF8("UTF-16BE", "\xD8\x3D\xDE\x00", 4, text));
+    EXPECT_EQ(text, "\xF0\x9F\x98\x80");
+    ASSERT_TRUE(MMSCharsetConverter::toUTF8("UTF-16", string("\xFF\xFE" "A\x00", 4).data(), 4, text));
+    EXPECT_EQ(text, "A");
+    ASSERT_TRUE(MMSCharsetConverter::toUTF8("UTF-16LE", "\x00\xD8", 2, text));
+    EXPECT_EQ(text, "\xEF\xBF\xBD");
+}
+
+TEST(CharsetTest, NativeDecodersLongInput) {
+    // 超过 8 字节时 ASCII 码元按块处理, 块内遇到非 ASCII 码元和末尾落单字节时逐个处理
+    string ucs2 = string("\x00H\x00" "e\x00l\x00l\x00o\x00,\x4E\x2D\x00 \x00w\x00o\x00r\x00l\x00" "d\x00", 27);
+    string text;
+    ASSERT_TRUE(MMSCharsetConverter::toUTF8("UTF-16BE", ucs2.data(), ucs2.size(), text));
+    EXPECT_EQ(text, "Hello,\xE4\xB8\xAD world\xEF\xBF\xBD");
+
+    string le;
+    for (size_t i = 0; i + 1 < ucs2.size(); i += 2) {
+        le.push_back(ucs2[i + 1]);
+        le.push_back(ucs2[i]);
+    }
+    ASSERT_TRUE(MMSCharsetConverter::toUTF8("UTF-16LE", le.data(), le.size(), text));
+    EXPECT_EQ(text, "Hello,\xE4\xB8\xAD world");
+
+    string latin1(100, 'a');
+    latin1[50] = '\xE9';
+    ASSERT_TRUE(MMSCharsetConverter::toUTF8("ISO-8859-1", latin1.data(), latin1.size(), text));
+    EXPECT_EQ(text, string(50, 'a') + "\xC3\xA9" + string(49, 'a'));
+}
+
+TEST(CharsetTest, TextPartBody) {
+    MMSEngine engine;
+    // M-Retrieve-Conf, 一个 text/plain; charset=ISO-10646-UCS-2 的 part
+    const unsigned char pdu[] = {
+            0x8C, 0x84,
+            0x84, 0xA3,
+            0x01,
+            0x06, 0x08,
+            0x05, 0x83, 0x81, 0x02, 0x03, 0xE8,
+            0x00, 0x48, 0x00, 0x69, 0x4E, 0x2D, 0x65, 0x87};
+    std::unique_ptr<MMSInfo> info(engine.parse(pdu, sizeof(pdu)));
+    ASSERT_NE(info, nullptr);
+    ASSERT_EQ(info->body()->size(), 1u);
+    const MMSPart &part = info->body()->front();
+    EXPECT_EQ(part.dataLen(), 8);
+    EXPECT_EQ(part.text(), "Hi\xE4\xB8\xAD\xE6\x96\x87");
+}
+
+TEST(CharsetTest, ScratchGrowsOnExpansion) {
+    // GB2312 每个汉字 2 字节, 转换为 UTF-8 后为 3 字节
+    string gb;
+    string expected;
+    for (int i = 0; i < 1000; i++) {
+        gb += "\xD6\xD0\xCE\xC4";
+        expected += "\xE4\xB8\xAD\xE6\x96\x87";
+    }
+
+    vector<char> scratch(4);
+    string text;
+    ASSERT_TRUE(MMSCharsetConverter::toUTF8("GB2312", gb.data(), gb.size(), scratch, text));
+    EXPECT_EQ(text, expected);
+    size_t capacity = scratch.size();
+
+    ASSERT_TRUE(MMSCharsetConverter::toUTF8("GB2312", "\xD6\xD0\xCE\xC4", 4, scratch, text));
+    EXPECT_EQ(text, "\xE4\xB8\xAD\xE6\x96\x87");
+    EXPECT_EQ(scratch.size(), capacity);
+}
@@ -0,0 +1,75 @@
+#include <gtest/gtest.h>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <vector>
+#include "MMSEngine.h"
+
+using namespace std;
+
+static vector<char> readResource(const string &path) {
+    ifstream in(path, ios::binary);
+    return {istreambuf_iterator<char>(in), istreambuf_iterator<char>()};
+}
+
+TEST(EngineBufferTest, ParseFromMemoryMatchesFile) {
+    MMSEngine engine;
+    string mmsHexFilePath = "resource/160767603214113640";
+    vector<char> pdu = readResource(mmsHexFilePath);
+    ASSERT_FALSE(pdu.empty());
+
+    MMSInfo *info = engine.parse(pdu.data(), pdu.size());
+    ASSERT_NE(info, nullptr);
+    EXPECT_EQ(info->toPlain(true), engine.convert2Plain(mmsHexFilePath, true));
+
+    ASSERT_EQ(info->body()->size(), 4u);
+    for (auto &part: *info->body()) {
+        EXPECT_GE(part.data(), pdu.data());
+        EXPECT_LE(part.data() + part.dataLen(), pdu.data() + pdu.size());
+    }
+    delete info;
+}
+
+TEST(EngineBufferTest, TruncatedBuffer) {
+    MMSEngine engine;
+    vector<char> pdu = readResource("resource/160767603214113640");
+    std::unique_ptr<MMSInfo> full(engine.parse(pdu.data(), pdu.size()));
+    ASSERT_NE(full, nullptr);
+    size_t headerFields = full->header()->size();
+
+    // 结果中的 part 和延迟解码都引用截断后的缓冲区, 需要保持到结果释放之后
+    vector<char> truncated;
+    auto parseTruncated = [&](size_t len, const MMSParseOptions &options) {
+        truncated.assign(pdu.begin(), pdu.begin() + (ptrdiff_t) len);
+        return std::unique_ptr<MMSInfo>(engine.parse(truncated.data(), truncated.size(), options));
+    };
+
+    // 头字段中间(Transaction-Id, Content-Type), 字段边界(Date 之后), 头结束但没有 part 表, part 数据中间
+    for (size_t len: {20, 59, 130, 141, 1024}) {
+        EXPECT_EQ(parseTruncated(len, MMSParseOptions()), nullptr) << "truncated at " << len;
+    }
+    for (size_t len = 1; len < pdu.size(); len += (len < 1024 ? 1 : 4099)) {
+        EXPECT_EQ(parseTruncated(len, MMSParseOptions()), nullptr) << "truncated at " << len;
+    }
+
+    // 投影的字段在截断点之前时只解析头, 结果有效且不越界
+    MMSParseOptions projection;
+    projection.headerFields = {"Message-ID"};
+    std::unique_ptr<MMSInfo> info = parseTruncated(59, projection);
+    ASSERT_NE(info, nullptr);
+    ASSERT_EQ(info->header()->size(), 1u);
+    EXPECT_LE(info->header()->front().value.end, 59u);
+
+    // 延迟解码时头完整即返回结果, 截断的 part 表在访问时报错
+    MMSParseOptions lazy;
+    lazy.lazyBody = true;
+    info = parseTruncated(1024, lazy);
+    ASSERT_NE(info, nullptr);
+    EXPECT_EQ(info->header()->size(), headerFields);
+    EXPECT_THROW(info->body(), MMSParseError);
+}
+
+TEST(EngineBufferTest, EmptyBuffer) {
+    MMSEngine engine;
+    EXPECT_EQ(engine.parse(nullptr, 0), nullptr);
+}
@@ -0,0 +1,68 @@
+#include <gtest/gtest.h>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <vector>
+#include "MMSEngine.h"
+
+using namespace std;
+
+static vector<char> readResource(const string &path) {
+    ifstream in(path, ios::binary);
+    return {istreambuf_iterator<char>(in), istreambuf_iterator<char>()};
+}
+
+TEST(HeaderProjectionTest, FirstOccurrence) {
+    MMSEngine engine;
+    vector<char> pdu = readResource("resource/160767603214113640");
+
+    MMSParseOptions options;
+    options.headerFields = {"Message-ID", "From", "To"};
+    MMSInfo *info = engine.parse(pdu.data(), pdu.size(), options);
+    ASSERT_NE(info, nullptr);
+
+    vector<pair<string, string>> expected = {
+            {"Message-ID", "ZXyOEFcc5PxzHMuY"},
+            {"To",         "66855734051/TYPE+PLMN"},
+            {"From",       "HyperSMS"}};
+    ASSERT_EQ(info->header()->size(), expected.size());
+    auto it = info->header()->begin();
+    for (auto &e: expected) {
+        EXPECT_EQ(it->name.value, e.first);
+        EXPECT_EQ(it->value.value, e.second);
+        ++it;
+    }
+    EXPECT_TRUE(info->body()->empty());
+    delete info;
+}
+
+TEST(HeaderProjectionTest, MultipleRecipients) {
+    MMSEngine engine;
+    // 每个收件人一个 To/Cc 字段, 投影时要收集全部地址, 而不是只取第一个
+    const unsigned char pdu[] = {
+            0x8C, 0x82,
+            0x97, 'a', 0x00,
+            0x8B, 'i', 'd', 0x00,
+            0x82, 'c', 0x00,
+            0x97, 'b', 0x00,
+            0x96, 's', 0x00,
+            0x97, 'd', 0x00,
+            0x84, 0x83};
+    MMSParseOptions options;
+    options.headerFields = {"Message-ID", "To"};
+    std::unique_ptr<MMSInfo> info(engine.parse(pdu, sizeof(pdu), options));
+    ASSERT_NE(info, nullptr);
+
+    vector<pair<string, string>> expected = {
+            {"To",         "a"},
+            {"Message-ID", "id"},
+            {"To",         "b"},
+            {"To",         "d"}};
+    ASSERT_EQ(info->header()->size(), expected.size());
+    auto it = info->header()->begin();
+    for (auto &e: expected) {
+        EXPECT_EQ(it->name.value, e.first);
+        EXPECT_EQ(it->value.value, e.second);
+        ++it;
+    }
+}
@@ -0,0 +1,115 @@
+#include <gtest/gtest.h>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <vector>
+#include "MMSEngine.h"
+
+using namespace std;
+
+static vector<char> readResource(const string &path) {
+    ifstream in(path, ios::binary);
+    return {istreambuf_iterator<char>(in), istreambuf_iterator<char>()};
+}
+
+static const field *findField(const MMSHeaderList &header, const string &name) {
+    for (auto &f: header) {
+        if (f.name.value == name) {
+            return &f;
+        }
+    }
+    return nullptr;
+}
+
+TEST(HeaderValueTest, TypedValues) {
+    MMSEngine engine;
+    vector<char> pdu = readResource("resource/160767603214113640");
+    MMSInfo *info = engine.parse(pdu.data(), pdu.size());
+    ASSERT_NE(info, nullptr);
+
+    const MMSHeaderList &header = *info->header();
+    const field *messageType = findField(header, "Message-Type");
+    ASSERT_NE(messageType, nullptr);
+    EXPECT_EQ(messageType->typed.type, MMS_VALUE_ENUM);
+    EXPECT_EQ(messageType->typed.number, 0x84);
+    EXPECT_EQ(messageType->typed.symbol, "M-Retrieve-Conf");
+    EXPECT_TRUE(messageType->value.value.empty());
+
+    const field *date = findField(header, "Date");
+    ASSERT_NE(date, nullptr);
+    EXPECT_EQ(date->typed.type, MMS_VALUE_TIMESTAMP);
+    EXPECT_EQ(date->typed.number, 1607676142);
+    EXPECT_EQ(date->text(), "1607676142");
+
+    const field *from = findField(header, "From");
+    ASSERT_NE(from, nullptr);
+    EXPECT_EQ(from->typed.type, MMS_VALUE_TEXT);
+    EXPECT_EQ(from->text(), "HyperSMS");
+    delete info;
+}
+
+TEST(HeaderValueTest, LongIntegerRange) {
+    MMSEngine engine;
+    // 最高字节 >= 0x80 的 4 字节 Date 和 Message-Size 不应被符号扩展
+    const unsigned char pdu[] = {
+            0x8C, 0x82,
+            0x85, 0x04, 0xF0, 0x00, 0x00, 0x00,
+            0x8E, 0x04, 0x80, 0x00, 0x00, 0x01,
+            0x84, 0x83};
+    std::unique_ptr<MMSInfo> info(engine.parse(pdu, sizeof(pdu)));
+    ASSERT_NE(info, nullptr);
+    const MMSHeaderList &header = *info->header();
+    ASSERT_EQ(header.size(), 4u);
+    EXPECT_EQ(header[1].typed.number, 0xF0000000L);
+    EXPECT_EQ(header[2].typed.number, 0x80000001L);
+
+    // Short-length 超过 long 的字节数时报错, 不做越界移位
+    const unsigned char tooLong[] = {
+            0x8C, 0x82,
+            0x85, 0x09, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09,
+            0x84, 0x83};
+    EXPECT_EQ(std::unique_ptr<MMSInfo>(engine.parse(tooLong, sizeof(tooLong))), nullptr);
+
+    vector<unsigned char> longest = {0x8C, 0x82, 0x85, 0x1E};
+    longest.insert(longest.end(), 30, 0xFF);
+    longest.push_back(0x84);
+    longest.push_back(0x83);
+    EXPECT_EQ(std::unique_ptr<MMSInfo>(engine.parse(longest.data(), longest.size())), nullptr);
+}
+
+TEST(HeaderValueTest, ExpiryForms) {
+    MMSEngine engine;
+    // M-Notification-Ind, 三种形式的 Expiry, 最后是 Content-Type, 用于检查每种形式消耗的字节数
+    const unsigned char pdu[] = {
+            0x8C, 0x82,
+            // 绝对时间: Value-length Absolute-token Long-integer(0x5FD3B1EE)
+            0x88, 0x06, 0x80, 0x04, 0x5F, 0xD3, 0xB1, 0xEE,
+            // 相对时间: Value-length Relative-token Long-integer(3600)
+            0x88, 0x04, 0x81, 0x02, 0x0E, 0x10,
+            // 未知 token
+            0x88, 0x03, 0x82, 0xAA, 0xBB,
+            0x84, 0x83};
+    MMSInfo *info = engine.parse(pdu, sizeof(pdu));
+    ASSERT_NE(info, nullptr);
+
+    const MMSHeaderList &header = *info->header();
+    ASSERT_EQ(header.size(), 5u);
+
+    EXPECT_EQ(header[1].typed.type, MMS_VALUE_TIMESTAMP);
+    EXPECT_EQ(header[1].typed.number, 0x5FD3B1EE);
+    EXPECT_EQ(header[1].value.end, 10u);
+
+    EXPECT_EQ(header[2].typed.type, MMS_VALUE_DELTA);
+    EXPECT_EQ(header[2].typed.number, 3600);
+    EXPECT_EQ(header[2].text(), "+3600");
+    EXPECT_EQ(header[2].value.end, 16u);
+
+    EXPECT_EQ(header[3].typed.type, MMS_VALUE_TEXT);
+    EXPECT_EQ(header[3].value.value, "0x82AABB");
+    EXPECT_EQ(header[3].text(), "0x82AABB");
+    EXPECT_EQ(header[3].value.end, 21u);
+
+    EXPECT_EQ(header[4].name.value, "Content-Type");
+    EXPECT_EQ(header[4].text(), "text/plain");
+    delete info;
+}
@@ -0,0 +1,44 @@
+#include <gtest/gtest.h>
+#include <fstream>
+#include <iterator>
+#include <vector>
+#include "MMSEngine.h"
+
+using namespace std;
+
+static vector<char> readResource(const string &path) {
+    ifstream in(path, ios::binary);
+    return {istreambuf_iterator<char>(in), istreambuf_iterator<char>()};
+}
+
+TEST(LazyBodyTest, MatchesEager) {
+    MMSEngine engine;
+    vector<char> pdu = readResource("resource/163903889557724545");
+
+    MMSParseOptions options;
+    options.lazyBody = true;
+    MMSInfo *lazy = engine.parse(pdu.data(), pdu.size(), options);
+    MMSInfo *eager = engine.parse(pdu.data(), pdu.size());
+    ASSERT_NE(lazy, nullptr);
+    ASSERT_NE(eager, nullptr);
+
+    EXPECT_EQ(lazy->header()->size(), eager->header()->size());
+    EXPECT_EQ(lazy->body()->size(), 5u);
+    EXPECT_EQ(lazy->toPlain(true), eager->toPlain(true));
+    delete lazy;
+    delete eager;
+}
+
+TEST(LazyBodyTest, TruncatedPartTable) {
+    MMSEngine engine;
+    vector<char> pdu = readResource("resource/163903889557724545");
+    pdu.resize(pdu.size() - 100);
+
+    MMSParseOptions options;
+    options.lazyBody = true;
+    MMSInfo *lazy = engine.parse(pdu.data(), pdu.size(), options);
+    ASSERT_NE(lazy, nullptr);
+    EXPECT_THROW(lazy->body(), MMSParseError);
+    EXPECT_THROW(lazy->toPlain(false), MMSParseError);
+    delete lazy;
+}
@@ -0,0 +1,243 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <thread>
+#include "MMSEngine.h"
+#include "../MMSMetaDataRegistry.h"
+#include "../MMSMetaDataSnapshot.h"
+
+using namespace std;
+
+TEST(MetaDataTest, FullWidthCharset) {
+    MMSMetaDataManager manager;
+    EXPECT_EQ(manager.findCharacterSetByCode(3), "US-ASCII");
+    EXPECT_EQ(manager.findCharacterSetByCode(106), "UTF-8");
+    EXPECT_EQ(manager.findCharacterSetByCode(1000), "ISO-10646-UCS-2");
+    EXPECT_EQ(manager.findCharacterSetByCode(1015), "UTF-16");
+    EXPECT_EQ(manager.findCharacterSetByCode(2026), "Big5");
+    EXPECT_NE(manager.findCharacterSetByCode(1000 & 0x7F), "ISO-10646-UCS-2");
+    EXPECT_EQ(manager.findCharacterSetByCode(-1), "");
+    EXPECT_EQ(manager.findCharacterSetByCode(100000), "");
+}
+
+TEST(MetaDataTest, LongIntegerCharsetParameter) {
+    MMSEngine engine;
+    // M-Notification-Ind, Subject = Value-length Long-integer(1000) UCS-2 "Hi", Content-Type = text/plain
+    const unsigned char pdu[] = {
+            0x8C, 0x82,
+            0x96, 0x08, 0x02, 0x03, 0xE8, 0x00, 'H', 0x00, 'i', 0x00,
+            0x84, 0x83};
+    MMSInfo *info = engine.parse(pdu, sizeof(pdu));
+    ASSERT_NE(info, nullptr);
+    ASSERT_EQ(info->header()->size(), 3u);
+    EXPECT_EQ(info->header()->front().text(), "M-Notification-Ind");
+    auto subject = info->header()->begin() + 1;
+    EXPECT_EQ(subject->value.value, std::string("\0H\0i", 4));
+    EXPECT_EQ(subject->charset.mibEnum, 1000);
+    EXPECT_EQ(subject->text(), "Hi");
+    EXPECT_EQ(subject->value.end - subject->value.start, 9u);
+    delete info;
+}
+
+TEST(MetaDataTest, TextStringCharsetParameter) {
+    MMSEngine engine;
+    // Subject 的字符集以 Text-string 声明: 元数据中没有的 ISO-8859-1 别名, 以及小写的 utf-8
+    const unsigned char pdu[] = {
+            0x8C, 0x82,
+            0x96, 0x0F, 'I', 'S', 'O', '-', '8', '8', '5', '9', '-', '1', 0x00, 0xE9, 't', 0xE9, 0x00,
+            0x96, 0x09, 'u', 't', 'f', '-', '8', 0x00, 'O', 'k', 0x00,
+            0x84, 0x83};
+    MMSInfo *info = engine.parse(pdu, sizeof(pdu));
+    ASSERT_NE(info, nullptr);
+    ASSERT_EQ(info->header()->size(), 4u);
+
+    const field &latin1 = (*info->header())[1];
+    EXPECT_EQ(latin1.value.value, "\xE9t\xE9");
+    EXPECT_EQ(latin1.charset.mibEnum, -1);
+    EXPECT_EQ(latin1.charset.name, "ISO-8859-1");
+    EXPECT_EQ(latin1.text(), "\xC3\xA9t\xC3\xA9");
+
+    const field &utf8 = (*info->header())[2];
+    EXPECT_EQ(utf8.value.value, "Ok");
+    EXPECT_TRUE(utf8.charset.name.empty());
+    EXPECT_EQ(utf8.text(), "Ok");
+    delete info;
+}
+
+TEST(MetaDataTest, InternedNames) {
+    MMSMetaDataManager builtin;
+    MMSMetaDataManager other;
+    MMSMetaDataManager json("metadata");
+    // 内置元数据的名字直接指向编译进库的字符串池, 不做复制
+    EXPECT_EQ(builtin.findFieldNameByCode(0x84).c_str(), other.findFieldNameByCode(0x84).c_str());
+    EXPECT_EQ(builtin.findFieldNameByCode(0x84), json.findFieldNameByCode(0x84));
+    EXPECT_EQ(builtin.findFieldNameByCode(0x84), MMSName::intern("Content-Type"));
+    MMSMetaDataManager copy = json;
+    EXPECT_EQ(copy.findFieldNameByCode(0x84).c_str(), json.findFieldNameByCode(0x84).c_str());
+    EXPECT_EQ(builtin.findParamWellknownByCode(0x03), "Type,1.1");
+    EXPECT_EQ(builtin.findParamWellknownNameByCode(0x03), "Type");
+    EXPECT_TRUE(builtin.findFieldNameByCode(0x7F).empty());
+}
+
+static void writeSnapshot(const string &path, const vector<char> &data) {
+    ofstream out(path, ios::binary);
+    out.write(data.data(), (streamsize) data.size());
+}
+
+TEST(MetaDataTest, BuiltinMatchesJson) {
+    MMSEngine builtin;
+    MMSEngine json("metadata");
+    MMSEngine snapshot("resource/metadata.snapshot");
+    string mmsHexFilePath = "resource/163903889557724545";
+    EXPECT_EQ(builtin.convert2Plain(mmsHexFilePath), json.convert2Plain(mmsHexFilePath));
+    EXPECT_EQ(builtin.convert2Plain(mmsHexFilePath), snapshot.convert2Plain(mmsHexFilePath));
+}
+
+TEST(MetaDataTest, SnapshotMapping) {
+    ifstream in("resource/metadata.snapshot", ios::binary);
+    vector<char> snapshot((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+    ASSERT_GT(snapshot.size(), sizeof(MetaSnapshotHeader));
+
+    // 映射由管理器及其副本共同持有
+    std::unique_ptr<MMSMetaDataManager> manager(new MMSMetaDataManager("resource/metadata.snapshot"));
+    MMSMetaDataManager copy = *manager;
+    manager.reset();
+    EXPECT_EQ(copy.findFieldNameByCode(0x84), "Content-Type");
+    EXPECT_EQ(copy.findCharacterSetCodeByName("utf-8"), 106);
+    EXPECT_EQ(copy.findParamWellknownByCode(0x03), "Type,1.1");
+
+    vector<char> truncated(snapshot.begin(), snapshot.end() - 1);
+    writeSnapshot("truncated.snapshot", truncated);
+    EXPECT_THROW(MMSMetaDataManager("truncated.snapshot"), std::runtime_error);
+
+    vector<char> badCount = snapshot;
+    reinterpret_cast<MetaSnapshotHeader *>(badCount.data())->entryCount = 0xFFFFFFFF;
+    writeSnapshot("bad-count.snapshot", badCount);
+    EXPECT_THROW(MMSMetaDataManager("bad-count.snapshot"), std::runtime_error);
+
+    vector<char> badName = snapshot;
+    auto header = reinterpret_cast<const MetaSnapshotHeader *>(badName.data());
+    size_t entryOffset = sizeof(MetaSnapshotHeader) + header->tableCount * sizeof(MetaLayoutTable);
+    reinterpret_cast<MetaLayoutEntry *>(badName.data() + entryOffset)->name = header->stringPoolSize;
+    writeSnapshot("bad-name.snapshot", badName);
+    EXPECT_THROW(MMSMetaDataManager("bad-name.snapshot"), std::runtime_error);
+}
+
+TEST(MetaDataTest, ReverseLookup) {
+    MMSMetaDataManager manager;
+    EXPECT_EQ(manager.findFieldCodeByName("Message-Type"), 0x0C);
+    EXPECT_EQ(manager.findFieldCodeByName("message-type"), 0x0C);
+    EXPECT_EQ(manager.findFieldCodeByName("X-Unknown"), -1);
+    EXPECT_EQ(manager.findCharacterSetCodeByName("UTF-8"), 106);
+    EXPECT_EQ(manager.findCharacterSetCodeByName("utf-8"), 106);
+    EXPECT_EQ(manager.findCharacterSetCodeByName("ISO-10646-UCS-2"), 1000);
+    EXPECT_EQ(manager.findContentTypeCodeByName("image/jpeg"), 0x1E);
+    EXPECT_EQ(manager.findMessageTypeCodeByName("M-Retrieve-Conf"), 0x84);
+    EXPECT_EQ(manager.findParamWellknownCodeByName("Type"), 0x03);
+    EXPECT_EQ(manager.findParamWellknownCodeByName("Type,1.1"), 0x03);
+    EXPECT_EQ(manager.findParamFieldCodeByName(""), -1);
+
+    for (int code = 0; code < 0x80; code++) {
+        MMSName name = manager.findContentTypeByCode((unsigned char) code);
+        if (!name.empty()) {
+            EXPECT_EQ(manager.findContentTypeByCode((unsigned char) manager.findContentTypeCodeByName(name)), name);
+        }
+    }
+    for (int code = 0; code < 3000; code++) {
+        MMSName name = manager.findCharacterSetByCode(code);
+        if (!name.empty()) {
+            EXPECT_EQ(manager.findCharacterSetByCode(manager.findCharacterSetCodeByName(name)), name);
+        }
+    }
+}
+
+TEST(MetaDataTest, RegistrySharesInstances) {
+    auto builtin = MMSMetaDataRegistry::slot("");
+    EXPECT_EQ(builtin, MMSMetaDataRegistry::slot(""));
+    auto json = MMSMetaDataRegistry::slot("metadata");
+    EXPECT_EQ(json, MMSMetaDataRegistry::slot("metadata/"));
+    EXPECT_EQ(json, MMSMetaDataRegistry::slot("./metadata"));
+    EXPECT_EQ(json->snapshot(), MMSMetaDataRegistry::get("metadata"));
+    EXPECT_NE(builtin->snapshot(), json->snapshot());
+    EXPECT_THROW(MMSMetaDataRegistry::get("not-exist-dir"), std::runtime_error);
+}
+
+TEST(MetaDataTest, RegistryLoadsOnce) {
+    ifstream in("resource/metadata.snapshot", ios::binary);
+    writeSnapshot("registry.snapshot", vector<char>((istreambuf_iterator<char>(in)), istreambuf_iterator<char>()));
+
+    std::shared_ptr<const MMSMetaDataManager> loaded;
+    {
+        MMSEngine engine("registry.snapshot");
+        loaded = MMSMetaDataRegistry::get("registry.snapshot");
+    }
+    // 之后创建引擎不再加载, 也不再访问文件系统
+    std::remove("registry.snapshot");
+    MMSEngine engine("registry.snapshot");
+    EXPECT_EQ(MMSMetaDataRegistry::get("registry.snapshot"), loaded);
+
+    // 移除后再获取时重新加载, 文件已不存在
+    MMSMetaDataRegistry::evict("registry.snapshot");
+    EXPECT_THROW(MMSMetaDataRegistry::get("registry.snapshot"), std::runtime_error);
+    // 已创建的引擎继续使用原来的元数据
+    const unsigned char pdu[] = {0x8C, 0x82, 0x84, 0x83};
+    std::unique_ptr<MMSInfo> info(engine.parse(pdu, sizeof(pdu)));
+    ASSERT_NE(info, nullptr);
+    EXPECT_EQ(info->header()->front().text(), "M-Notification-Ind");
+}
+
+TEST(MetaDataTest, ReloadPublishesNewGeneration) {
+    MMSEngine engine("metadata");
+    auto before = MMSMetaDataRegistry::get("metadata");
+    const unsigned char pdu[] = {0x8C, 0x82, 0x84, 0x83};
+
+    std::atomic<bool> stop(false);
+    std::atomic<int> failures(0);
+    std::thread parser([&engine, &pdu, &stop, &failures]() {
+        while (!stop) {
+            MMSInfo *info = engine.parse(pdu, sizeof(pdu));
+            if (info == nullptr || info->header()->front().typed.symbol != "M-Notification-Ind") {
+                failures++;
+            }
+            delete info;
+        }
+    });
+    for (int i = 0; i < 3; i++) {
+        MMSMetaDataRegistry::reload("metadata").get();
+    }
+    stop = true;
+    parser.join();
+
+    auto after = MMSMetaDataRegistry::get("metadata");
+    EXPECT_EQ(after, MMSMetaDataRegistry::get("metadata"));
+    EXPECT_EQ(failures, 0);
+    EXPECT_NE(before, after);
+    EXPECT_EQ(before->findFieldNameByCode(0x84), after->findFieldNameByCode(0x84));
+    EXPECT_THROW(MMSMetaDataRegistry::reload("not-exist-dir").get(), std::runtime_error);
+}
+
+TEST(MetaDataTest, ReloadInBackground) {
+    MMSEngine engine("metadata");
+    auto before = MMSMetaDataRegistry::get("metadata");
+    // 丢弃返回的 future 不等待加载完成
+    MMSMetaDataRegistry::reload("metadata");
+    for (int i = 0; i < 1000 && MMSMetaDataRegistry::get("metadata") == before; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    EXPECT_NE(MMSMetaDataRegistry::get("metadata"), before);
+
+    // 交替使用两个槽位时各自取得自己的版本
+    auto builtin = MMSMetaDataRegistry::slot("");
+    auto json = MMSMetaDataRegistry::slot("metadata");
+    auto builtinSnapshot = builtin->snapshot();
+    auto jsonSnapshot = json->snapshot();
+    for (int i = 0; i < 4; i++) {
+        EXPECT_EQ(builtin->snapshot(), builtinSnapshot);
+        EXPECT_EQ(json->snapshot(), jsonSnapshot);
+    }
+    EXPECT_NE(builtinSnapshot, jsonSnapshot);
+}
@@ -0,0 +1,34 @@
+#include <gtest/gtest.h>
+#include <fstream>
+#include <iterator>
+#include <type_traits>
+#include <vector>
+#include "MMSEngine.h"
+
+using namespace std;
+
+static vector<char> readResource(const string &path) {
+    ifstream in(path, ios::binary);
+    return {istreambuf_iterator<char>(in), istreambuf_iterator<char>()};
+}
+
+TEST(MMSInfoTest, MoveOnly) {
+    static_assert(!std::is_copy_constructible<MMSInfo>::value, "MMSInfo is move-only");
+    static_assert(!std::is_copy_constructible<MMSPart>::value, "MMSPart is move-only");
+    static_assert(std::is_nothrow_move_constructible<MMSInfo>::value, "MMSInfo moves must not throw");
+
+    MMSEngine engine;
+    vector<char> pdu = readResource("resource/160767603214113640");
+    MMSInfo *info = engine.parse(pdu.data(), pdu.size());
+    ASSERT_NE(info, nullptr);
+    string plain = info->toPlain(true);
+    const char *firstPartData = info->body()->front().data();
+    // 完整解析的头字段超过内联容量, 在堆上, 移动时只转移指针
+    const field *firstField = &info->header()->front();
+
+    MMSInfo moved(std::move(*info));
+    delete info;
+    EXPECT_EQ(moved.body()->front().data(), firstPartData);
+    EXPECT_EQ(&moved.header()->front(), firstField);
+    EXPECT_EQ(moved.toPlain(true), plain);
+}
@@ -0,0 +1,59 @@
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include "../MMSSmallVector.h"
+
+/**
+ * 移动构造可能抛出, 扩容时走复制构造, 第 throwAt 次复制时抛出
+ */
+struct ThrowingCopy {
+    static int live;
+    static int copies;
+    static int throwAt;
+    int value;
+
+    explicit ThrowingCopy(int value) : value(value) {
+        live++;
+    }
+
+    ThrowingCopy(const ThrowingCopy &other) : value(other.value) {
+        if (++copies == throwAt) {
+            throw std::runtime_error("copy failed");
+        }
+        live++;
+    }
+
+    ThrowingCopy(ThrowingCopy &&other) noexcept(false) : value(other.value) {
+        live++;
+    }
+
+    ~ThrowingCopy() {
+        live--;
+    }
+};
+
+int ThrowingCopy::live = 0;
+int ThrowingCopy::copies = 0;
+int ThrowingCopy::throwAt = 0;
+
+TEST(SmallVectorTest, GrowKeepsElementsWhenCopyThrows) {
+    {
+        MMSSmallVector<ThrowingCopy, 2> v;
+        v.emplace_back(1);
+        v.emplace_back(2);
+
+        ThrowingCopy::copies = 0;
+        ThrowingCopy::throwAt = 2;
+        EXPECT_THROW(v.reserve(8), std::runtime_error);
+        ASSERT_EQ(v.size(), 2u);
+        EXPECT_EQ(v.capacity(), 2u);
+        EXPECT_EQ(v[0].value, 1);
+        EXPECT_EQ(v[1].value, 2);
+        EXPECT_EQ(ThrowingCopy::live, 2);
+
+        ThrowingCopy::throwAt = 0;
+        v.reserve(8);
+        EXPECT_EQ(v.capacity(), 8u);
+        EXPECT_EQ(v[1].value, 2);
+    }
+    EXPECT_EQ(ThrowingCopy::live, 0);
+}
@@ -0,0 +1,123 @@
+#include <gtest/gtest.h>
+#include <fstream>
+#include <iterator>
+#include <vector>
+#include "MMSEngine.h"
+
+using namespace std;
+
+struct CollectListener : public MMSStreamListener {
+    vector<field> header;
+    vector<MMSPartHeaderList> partHeaders;
+    vector<string> partData;
+    bool headerEnd = false;
+    bool end = false;
+    // 当前 feed 的数据范围, 用于检查 part 数据是否直接透传
+    const char *chunkBegin = nullptr;
+    const char *chunkEnd = nullptr;
+    bool dataPassedThrough = true;
+
+    void onHeaderField(const field &f) override {
+        EXPECT_FALSE(headerEnd);
+        header.push_back(f);
+    }
+
+    void onHeaderEnd() override {
+        headerEnd = true;
+    }
+
+    void onPartBegin(const MMSPartHeaderList &h, long dataLen) override {
+        partHeaders.push_back(h);
+        partData.emplace_back();
+        partData.back().reserve(dataLen);
+    }
+
+    void onPartData(const char *data, size_t len) override {
+        dataPassedThrough = dataPassedThrough && data >= chunkBegin && data + len <= chunkEnd;
+        partData.back().append(data, len);
+    }
+
+    void onEnd() override {
+        end = true;
+    }
+};
+
+static vector<char> readResource(const string &path) {
+    ifstream in(path, ios::binary);
+    return {istreambuf_iterator<char>(in), istreambuf_iterator<char>()};
+}
+
+static void checkChunked(MMSEngine &engine, const string &path, size_t chunkSize) {
+    vector<char> pdu = readResource(path);
+    MMSInfo *info = engine.parse(pdu.data(), pdu.size());
+    ASSERT_NE(info, nullptr);
+
+    CollectListener listener;
+    MMSStreamParser *parser = engine.createStreamParser(listener);
+    for (size_t i = 0; i < pdu.size(); i += chunkSize) {
+        EXPECT_FALSE(listener.end);
+        size_t len = min(chunkSize, pdu.size() - i);
+        listener.chunkBegin = pdu.data() + i;
+        listener.chunkEnd = listener.chunkBegin + len;
+        parser->feed(listener.chunkBegin, len);
+    }
+    EXPECT_TRUE(listener.dataPassedThrough);
+    EXPECT_TRUE(parser->finished());
+    EXPECT_TRUE(listener.end);
+    delete parser;
+
+    ASSERT_EQ(listener.header.size(), info->header()->size());
+    auto it = info->header()->begin();
+    for (auto &f: listener.header) {
+        EXPECT_EQ(f.name.value, it->name.value);
+        EXPECT_EQ(f.value.value, it->value.value);
+        EXPECT_EQ(f.text(), it->text());
+        EXPECT_EQ(f.value.start, it->value.start);
+        ++it;
+    }
+
+    ASSERT_EQ(listener.partData.size(), info->body()->size());
+    size_t i = 0;
+    for (auto &part: *info->body()) {
+        EXPECT_EQ(listener.partData[i], string(part.data(), part.dataLen()));
+        ASSERT_EQ(listener.partHeaders[i].size(), part.header().size());
+        EXPECT_EQ(listener.partHeaders[i].back().value.value, part.header().back().value.value);
+        i++;
+    }
+    delete info;
+}
+
+TEST(StreamParserTest, ByteByByte) {
+    MMSEngine engine;
+    checkChunked(engine, "resource/160767603214113640", 1);
+}
+
+TEST(StreamParserTest, OddChunks) {
+    MMSEngine engine;
+    checkChunked(engine, "resource/160767603214113640", 7);
+    checkChunked(engine, "resource/163903889557724545", 4093);
+}
+
+TEST(StreamParserTest, SingleChunk) {
+    MMSEngine engine;
+    checkChunked(engine, "resource/163903889557724545", 1 << 24);
+}
+
+TEST(StreamParserTest, UnterminatedFieldIsBounded) {
+    MMSEngine engine;
+    CollectListener listener;
+    MMSStreamParser *parser = engine.createStreamParser(listener);
+
+    // Message-ID 的 text-string 一直没有结束符
+    vector<char> chunk(4096, 'a');
+    chunk[0] = (char) 0x8B;
+    parser->feed(chunk.data(), chunk.size());
+    chunk[0] = 'a';
+    EXPECT_THROW({
+                     for (int i = 0; i < 64; i++) {
+                         parser->feed(chunk.data(), chunk.size());
+                     }
+                 }, MMSParseError);
+    EXPECT_TRUE(listener.header.empty());
+    delete parser;
+}